@@ -0,0 +1,63 @@
+#include <intrusive/intrusive.h>
+
+#include <catch.hpp>
+
+#include <common/allocations_budget.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Node : SimpleRefCounted<Node> {
+    virtual ~Node() = default;
+    int value = 0;
+};
+
+struct Leaf : Node {
+    int extra = 0;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("IntrusivePtr budgets") {
+    SECTION("Construction") {
+        EXPECT_NO_ALLOCATIONS(IntrusivePtr<Node> p);
+        EXPECT_NO_ALLOCATIONS(IntrusivePtr<Node> p(nullptr));
+
+        // The counter lives in the object itself: one allocation of exactly `sizeof(T)`.
+        EXPECT_ALLOCATIONS_WITHIN(1, sizeof(Node), auto p = MakeIntrusive<Node>());
+        EXPECT_ALLOCATIONS_WITHIN(1, sizeof(Leaf), auto p = MakeIntrusive<Leaf>());
+
+        auto* raw = new Node;
+        EXPECT_NO_ALLOCATIONS(IntrusivePtr<Node> p(raw));
+    }
+
+    auto p = MakeIntrusive<Node>();
+
+    SECTION("Copy and move") {
+        EXPECT_NO_ALLOCATIONS(IntrusivePtr<Node> copy(p));
+        EXPECT_NO_ALLOCATIONS(IntrusivePtr<Node> copy(p);
+                              IntrusivePtr<Node> moved(std::move(copy)));
+
+        IntrusivePtr<Node> other;
+        EXPECT_NO_ALLOCATIONS(other = p);
+        EXPECT_NO_ALLOCATIONS(IntrusivePtr<Node> tmp(p); other = std::move(tmp));
+        EXPECT_NO_ALLOCATIONS(other.Swap(p));
+    }
+
+    SECTION("Converting constructors") {
+        auto leaf = MakeIntrusive<Leaf>();
+        EXPECT_NO_ALLOCATIONS(IntrusivePtr<Node> node(leaf));
+        EXPECT_NO_ALLOCATIONS(IntrusivePtr<Leaf> tmp(leaf);
+                              IntrusivePtr<Node> node(std::move(tmp)));
+    }
+
+    SECTION("Reset") {
+        auto* raw = new Node;
+        EXPECT_NO_ALLOCATIONS(p.Reset(raw));
+        EXPECT_NO_ALLOCATIONS(p.Reset());
+        EXPECT_NO_ALLOCATIONS(p.Reset());
+    }
+}
@@ -0,0 +1,154 @@
+#include <shared-from-this/shared.h>
+#include <shared-from-this/weak.h>
+
+#include <catch.hpp>
+
+#include <common/allocations_budget.h>
+
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr size_t kWord = sizeof(void*);
+
+// A control block is a vtable pointer plus strong and weak counters. Anything above that
+// (two words) is a regression in the control block layout.
+constexpr size_t kControlBlockHeader = 2 * kWord;
+
+// `SharedPtr(T*)` and `Reset(T*)` allocate a header plus the owned pointer.
+constexpr size_t kPointerControlBlock = kControlBlockHeader + kWord;
+
+// `MakeShared<T>` allocates a header and the object itself, padded to the block alignment.
+template <typename T>
+constexpr size_t EmplaceControlBlock() {
+    constexpr size_t kAlign = alignof(T) > alignof(void*) ? alignof(T) : alignof(void*);
+    return (kControlBlockHeader + sizeof(T) + kAlign - 1) / kAlign * kAlign;
+}
+
+struct Base {
+    virtual ~Base() = default;
+    int base_value = 1;
+};
+
+struct Derived : Base {
+    int derived_value = 2;
+};
+
+struct Widget : EnableSharedFromThis<Widget> {
+    int value = 0;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("SharedPtr budgets") {
+    SECTION("Construction") {
+        EXPECT_NO_ALLOCATIONS(SharedPtr<int> p);
+        EXPECT_NO_ALLOCATIONS(SharedPtr<int> p(nullptr));
+
+        int* raw = new int(42);
+        EXPECT_ALLOCATIONS_WITHIN(1, kPointerControlBlock, SharedPtr<int> p(raw));
+    }
+
+    SECTION("MakeShared") {
+        EXPECT_ALLOCATIONS_WITHIN(1, EmplaceControlBlock<int>(), auto p = MakeShared<int>(42));
+        EXPECT_ALLOCATIONS_WITHIN(1, EmplaceControlBlock<std::string>(),
+                                  auto p = MakeShared<std::string>("short"));
+    }
+
+    auto p = MakeShared<int>(42);
+
+    SECTION("Copy and move") {
+        EXPECT_NO_ALLOCATIONS(SharedPtr<int> copy(p));
+        EXPECT_NO_ALLOCATIONS(SharedPtr<int> copy(p); SharedPtr<int> moved(std::move(copy)));
+
+        SharedPtr<int> other;
+        EXPECT_NO_ALLOCATIONS(other = p);
+        EXPECT_NO_ALLOCATIONS(other = std::move(other));
+        EXPECT_NO_ALLOCATIONS(SharedPtr<int> tmp(p); other = std::move(tmp));
+        EXPECT_NO_ALLOCATIONS(other.Swap(p));
+    }
+
+    SECTION("Converting constructors") {
+        SharedPtr<Derived> derived = MakeShared<Derived>();
+        EXPECT_NO_ALLOCATIONS(SharedPtr<Base> base(derived));
+        EXPECT_NO_ALLOCATIONS(SharedPtr<Derived> tmp(derived);
+                              SharedPtr<Base> base(std::move(tmp)));
+    }
+
+    SECTION("Aliasing constructor") {
+        SharedPtr<Derived> derived = MakeShared<Derived>();
+        EXPECT_NO_ALLOCATIONS(SharedPtr<int> field(derived, &derived->derived_value));
+    }
+
+    SECTION("Reset") {
+        EXPECT_NO_ALLOCATIONS(p.Reset());
+        EXPECT_NO_ALLOCATIONS(p.Reset());
+
+        int* raw = new int(1);
+        EXPECT_ALLOCATIONS_WITHIN(1, kPointerControlBlock, p.Reset(raw));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("WeakPtr budgets") {
+    auto p = MakeShared<int>(42);
+
+    SECTION("Copy and move") {
+        EXPECT_NO_ALLOCATIONS(WeakPtr<int> w);
+        EXPECT_NO_ALLOCATIONS(WeakPtr<int> w(p));
+
+        WeakPtr<int> w(p);
+        EXPECT_NO_ALLOCATIONS(WeakPtr<int> copy(w));
+        EXPECT_NO_ALLOCATIONS(WeakPtr<int> copy(w); WeakPtr<int> moved(std::move(copy)));
+        EXPECT_NO_ALLOCATIONS(WeakPtr<int> other; other = w);
+        EXPECT_NO_ALLOCATIONS(WeakPtr<int> other; other = p);
+        EXPECT_NO_ALLOCATIONS(w.Reset());
+    }
+
+    SECTION("Converting constructors") {
+        SharedPtr<Derived> derived = MakeShared<Derived>();
+        WeakPtr<Derived> weak(derived);
+        EXPECT_NO_ALLOCATIONS(WeakPtr<Base> base(weak));
+        EXPECT_NO_ALLOCATIONS(WeakPtr<Base> base(derived));
+    }
+
+    SECTION("Lock") {
+        WeakPtr<int> w(p);
+        EXPECT_NO_ALLOCATIONS(auto locked = w.Lock());
+        EXPECT_NO_ALLOCATIONS(SharedPtr<int> promoted(w));
+
+        p.Reset();
+        EXPECT_NO_ALLOCATIONS(auto locked = w.Lock());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("EnableSharedFromThis budgets") {
+    SECTION("Construction") {
+        EXPECT_ALLOCATIONS_WITHIN(1, EmplaceControlBlock<Widget>(),
+                                  auto w = MakeShared<Widget>());
+
+        auto* raw = new Widget;
+        EXPECT_ALLOCATIONS_WITHIN(1, kPointerControlBlock, SharedPtr<Widget> w(raw));
+    }
+
+    auto widget = MakeShared<Widget>();
+
+    SECTION("SharedFromThis") {
+        EXPECT_NO_ALLOCATIONS(auto self = widget->SharedFromThis());
+
+        const Widget& cref = *widget;
+        EXPECT_NO_ALLOCATIONS(auto self = cref.SharedFromThis());
+    }
+
+    SECTION("WeakFromThis") {
+        EXPECT_NO_ALLOCATIONS(auto weak = widget->WeakFromThis());
+        EXPECT_NO_ALLOCATIONS(auto self = widget->WeakFromThis().Lock());
+    }
+}
@@ -0,0 +1,62 @@
+#include <unique/unique.h>
+
+#include <catch.hpp>
+
+#include <common/allocations_budget.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Base {
+    virtual ~Base() = default;
+};
+
+struct Derived : Base {
+    int value = 0;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("UniquePtr budgets") {
+    SECTION("Construction") {
+        EXPECT_NO_ALLOCATIONS(UniquePtr<int> p);
+
+        int* raw = new int(1);
+        EXPECT_NO_ALLOCATIONS(UniquePtr<int> p(raw));
+
+        int* array = new int[4];
+        EXPECT_NO_ALLOCATIONS(UniquePtr<int[]> p(array));
+    }
+
+    UniquePtr<int> p(new int(1));
+
+    SECTION("Move") {
+        EXPECT_NO_ALLOCATIONS(UniquePtr<int> moved(std::move(p)));
+
+        UniquePtr<int> other;
+        EXPECT_NO_ALLOCATIONS(other = std::move(p));
+        EXPECT_NO_ALLOCATIONS(other.Swap(p));
+
+        UniquePtr<int[]> array(new int[4]);
+        EXPECT_NO_ALLOCATIONS(UniquePtr<int[]> moved(std::move(array)));
+    }
+
+    SECTION("Converting constructors") {
+        UniquePtr<Derived> derived(new Derived);
+        EXPECT_NO_ALLOCATIONS(UniquePtr<Base> base(std::move(derived)));
+
+        UniquePtr<Derived> other(new Derived);
+        UniquePtr<Base> base;
+        EXPECT_NO_ALLOCATIONS(base = std::move(other));
+    }
+
+    SECTION("Reset and Release") {
+        int* raw = new int(2);
+        EXPECT_NO_ALLOCATIONS(p.Reset(raw));
+        EXPECT_NO_ALLOCATIONS(delete p.Release());
+        EXPECT_NO_ALLOCATIONS(p.Reset());
+    }
+}
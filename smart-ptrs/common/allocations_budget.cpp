@@ -0,0 +1,97 @@
+#include "allocations_budget.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+size_t allocations = 0;
+size_t bytes = 0;
+
+void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    ++allocations;
+    bytes += size;
+    if (size == 0) {
+        size = 1;
+    }
+    void* result = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        result = std::malloc(size);
+    } else {
+        result = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+    return result;
+}
+
+void* AllocateOrThrow(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    if (void* result = Allocate(size, alignment)) {
+        return result;
+    }
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+namespace alloc_budget {
+
+Counters Snapshot() {
+    return {allocations, bytes};
+}
+
+}  // namespace alloc_budget
+
+void* operator new(size_t size) {
+    return AllocateOrThrow(size);
+}
+
+void* operator new[](size_t size) {
+    return AllocateOrThrow(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts every call to the global `operator new` (all overloads) together with the number of
+// requested bytes. Link `allocations_budget` instead of `allocations_checker`: both replace the
+// global allocation functions, so a test binary can use only one of them.
+namespace alloc_budget {
+
+struct Counters {
+    size_t allocations = 0;
+    size_t bytes = 0;
+};
+
+Counters Snapshot();
+
+inline Counters Since(const Counters& start) {
+    Counters now = Snapshot();
+    return {now.allocations - start.allocations, now.bytes - start.bytes};
+}
+
+}  // namespace alloc_budget
+
+// Runs `X` and checks that it performed at most `MAX_ALLOCATIONS` allocations requesting at most
+// `MAX_BYTES` bytes in total. Objects declared in `X` are destroyed after the check.
+#define EXPECT_ALLOCATIONS_WITHIN(MAX_ALLOCATIONS, MAX_BYTES, X)                       \
+    do {                                                                               \
+        const auto alloc_budget_start = alloc_budget::Snapshot();                      \
+        X;                                                                             \
+        const auto alloc_budget_spent = alloc_budget::Since(alloc_budget_start);       \
+        REQUIRE(alloc_budget_spent.allocations <= static_cast<size_t>(MAX_ALLOCATIONS)); \
+        REQUIRE(alloc_budget_spent.bytes <= static_cast<size_t>(MAX_BYTES));           \
+    } while (0)
+
+#define EXPECT_NO_ALLOCATIONS(X) EXPECT_ALLOCATIONS_WITHIN(0, 0, X)
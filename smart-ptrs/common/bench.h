@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+// Keeps `value` alive for the optimizer without emitting any code.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs `body` once, prints and returns its time in ns divided by `operations`, the number of
+// operations it performs (e.g. over several threads).
+template <typename F>
+double MeasureBatchNsPerOp(const char* name, size_t operations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    double result = elapsed.count() / static_cast<double>(operations);
+    std::printf("%-56s %10.2f ns/op\n", name, result);
+    return result;
+}
+
+// Runs `body` `iterations` times, prints and returns the mean time of one iteration in ns.
+template <typename F>
+double MeasureNsPerOp(const char* name, size_t iterations, F&& body) {
+    return MeasureBatchNsPerOp(name, iterations, [&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            body();
+        }
+    });
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "numa.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/mman.h>
+
+// Allocator for large object graphs backed by 2 MB transparent huge pages.
+//
+// Memory comes in 2 MB regions aligned to 2 MB and advised with `MADV_HUGEPAGE`, so the kernel
+// can map each of them with a single TLB entry. If THP is disabled the advice is rejected and
+// the regions simply use normal pages; `GetStats` reports how many huge pages were really used.
+//
+// Every region serves one size class and starts with a header naming its arena, so a block is
+// freed from its address alone: `Deallocate(ptr)` needs neither the size nor the arena, which
+// keeps deleters stateless. Allocations above the largest class get a region of their own.
+// Thread-safe; nothing is returned to the system before the arena is destroyed, and the arena
+// must outlive every block allocated from it.
+class HugePageArena {
+public:
+    static constexpr size_t kRegionSize = size_t{2} << 20;
+    static constexpr size_t kMaxAlign = 64;
+
+    struct Stats {
+        size_t regions = 0;
+        size_t reserved_bytes = 0;
+        // Regions for which the kernel accepted the `MADV_HUGEPAGE` advice.
+        size_t advised_regions = 0;
+        // Huge pages actually backing the arena, from `/proc/self/smaps`.
+        size_t huge_pages = 0;
+    };
+
+    HugePageArena() = default;
+
+    // Regions are bound to NUMA node `numa_node` before they are touched (see `numa::BindToNode`).
+    explicit HugePageArena(int numa_node) : numa_node_(numa_node) {
+    }
+
+    HugePageArena(const HugePageArena&) = delete;
+    HugePageArena& operator=(const HugePageArena&) = delete;
+
+    ~HugePageArena() {
+        for (const Mapping& mapping : mappings_) {
+            munmap(mapping.base, mapping.size);
+        }
+    }
+
+    // Throws `std::invalid_argument` for alignments above `kMaxAlign`.
+    void* Allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        if (align > kMaxAlign || (align & (align - 1)) != 0) {
+            throw std::invalid_argument("HugePageArena: unsupported alignment");
+        }
+        size_t size_class = FindSizeClass(size, align);
+        std::lock_guard lock(mutex_);
+        if (size_class == kLarge) {
+            return AllocateLarge(size);
+        }
+        FreeBlock*& free_list = free_lists_[size_class];
+        if (free_list) {
+            FreeBlock* block = free_list;
+            free_list = block->next;
+            return block;
+        }
+        Carve& carve = carves_[size_class];
+        if (carve.next == carve.end) {
+            char* region = MapRegions(kRegionSize, size_class);
+            size_t count = (kRegionSize - kHeaderSize) / kSizeClasses[size_class];
+            carve.next = region + kHeaderSize;
+            carve.end = carve.next + count * kSizeClasses[size_class];
+        }
+        void* result = carve.next;
+        carve.next += kSizeClasses[size_class];
+        return result;
+    }
+
+    // Frees a block returned by `Allocate` of any arena.
+    static void Deallocate(void* ptr) {
+        if (!ptr) {
+            return;
+        }
+        auto* header = reinterpret_cast<RegionHeader*>(reinterpret_cast<uintptr_t>(ptr) &
+                                                        ~(uintptr_t{kRegionSize} - 1));
+        HugePageArena* arena = header->arena;
+        std::lock_guard lock(arena->mutex_);
+        if (header->size_class == kLarge) {
+            arena->ReleaseLarge(header);
+            return;
+        }
+        FreeBlock*& free_list = arena->free_lists_[header->size_class];
+        free_list = new (ptr) FreeBlock{free_list};
+    }
+
+    Stats GetStats() const {
+        Stats stats;
+        std::vector<Mapping> mappings;
+        {
+            std::lock_guard lock(mutex_);
+            mappings = mappings_;
+            stats.advised_regions = advised_regions_;
+        }
+        for (const Mapping& mapping : mappings) {
+            stats.regions += mapping.size / kRegionSize;
+            stats.reserved_bytes += mapping.size;
+        }
+        stats.huge_pages = CountHugePages(mappings);
+        return stats;
+    }
+
+private:
+    static constexpr size_t kHeaderSize = kMaxAlign;
+    static constexpr std::array<size_t, 16> kSizeClasses = {
+        16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 2048, 4096, 8192, 16384};
+    static constexpr size_t kLarge = kSizeClasses.size();
+
+    struct RegionHeader {
+        HugePageArena* arena;
+        size_t size_class;
+        size_t mapping_size;
+    };
+    static_assert(sizeof(RegionHeader) <= kHeaderSize);
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Carve {
+        char* next = nullptr;
+        char* end = nullptr;
+    };
+
+    struct Mapping {
+        char* base;
+        size_t size;
+    };
+
+    // The smallest class which fits `size` and keeps every block aligned to `align`: blocks of
+    // a class start at multiples of its size after a `kMaxAlign`-sized header.
+    static size_t FindSizeClass(size_t size, size_t align) {
+        for (size_t i = 0; i < kSizeClasses.size(); ++i) {
+            if (kSizeClasses[i] >= size && kSizeClasses[i] % align == 0) {
+                return i;
+            }
+        }
+        return kLarge;
+    }
+
+    // Maps `size` bytes (a multiple of `kRegionSize`) aligned to `kRegionSize`, by mapping more
+    // and trimming both ends.
+    char* MapRegions(size_t size, size_t size_class) {
+        // Grow the list first: a failure once the memory is mapped would leak it.
+        mappings_.reserve(mappings_.size() + 1);
+        void* raw = mmap(nullptr, size + kRegionSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        auto begin = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (begin + kRegionSize - 1) & ~(uintptr_t{kRegionSize} - 1);
+        if (aligned != begin) {
+            munmap(raw, aligned - begin);
+        }
+        munmap(reinterpret_cast<void*>(aligned + size), begin + kRegionSize - aligned);
+
+        auto* base = reinterpret_cast<char*>(aligned);
+        if (numa_node_ >= 0) {
+            numa::BindToNode(base, size, numa_node_);
+        }
+        if (madvise(base, size, MADV_HUGEPAGE) == 0) {
+            advised_regions_ += size / kRegionSize;
+        }
+        new (base) RegionHeader{this, size_class, size};
+        mappings_.push_back({base, size});
+        return base;
+    }
+
+    void* AllocateLarge(size_t size) {
+        if (size > SIZE_MAX - kHeaderSize - kRegionSize) {
+            throw std::bad_alloc();
+        }
+        size_t mapping_size = (size + kHeaderSize + kRegionSize - 1) / kRegionSize * kRegionSize;
+        return MapRegions(mapping_size, kLarge) + kHeaderSize;
+    }
+
+    void ReleaseLarge(RegionHeader* header) {
+        auto* base = reinterpret_cast<char*>(header);
+        for (size_t i = 0; i < mappings_.size(); ++i) {
+            if (mappings_[i].base == base) {
+                mappings_[i] = mappings_.back();
+                mappings_.pop_back();
+                break;
+            }
+        }
+        munmap(base, header->mapping_size);
+    }
+
+    // Sums `AnonHugePages` of the smaps entries lying inside the arena's mappings.
+    static size_t CountHugePages(const std::vector<Mapping>& mappings) {
+        FILE* smaps = std::fopen("/proc/self/smaps", "r");
+        if (!smaps) {
+            return 0;
+        }
+        size_t huge_kb = 0;
+        bool inside = false;
+        char line[512];
+        while (std::fgets(line, sizeof(line), smaps)) {
+            uintptr_t begin = 0;
+            uintptr_t end = 0;
+            size_t kb = 0;
+            if (std::sscanf(line, "%lx-%lx ", &begin, &end) == 2 && std::strchr(line, '-')) {
+                inside = false;
+                for (const Mapping& mapping : mappings) {
+                    auto base = reinterpret_cast<uintptr_t>(mapping.base);
+                    if (begin >= base && end <= base + mapping.size) {
+                        inside = true;
+                    }
+                }
+            } else if (inside && std::sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+                huge_kb += kb;
+            }
+        }
+        std::fclose(smaps);
+        return huge_kb / (kRegionSize >> 10);
+    }
+
+    mutable std::mutex mutex_;
+    std::array<FreeBlock*, kLarge> free_lists_ = {};
+    std::array<Carve, kLarge> carves_ = {};
+    std::vector<Mapping> mappings_;
+    size_t advised_regions_ = 0;
+    int numa_node_ = -1;
+};
+
+// Placement tag: `MakeShared<T>(HugePages{arena}, args...)` and the matching `MakeIntrusive` and
+// `MakeUnique` overloads construct the object in `arena`.
+struct HugePages {
+    HugePageArena& arena;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Thin wrappers over the NUMA memory policy syscalls, so nothing has to link libnuma. On a
+// single-node machine (or a kernel without NUMA support) every node id is 0 and binding is
+// skipped, which makes all of them harmless no-ops.
+namespace numa {
+
+// The largest node id the masks below can express.
+inline constexpr int kMaxNodes = 1024;
+
+namespace detail {
+
+constexpr size_t kBitsPerWord = 8 * sizeof(unsigned long);
+constexpr size_t kMaskWords = kMaxNodes / kBitsPerWord;
+
+struct NodeMask {
+    unsigned long words[kMaskWords] = {};
+
+    bool Has(int node) const {
+        if (node < 0 || node >= kMaxNodes) {
+            return false;
+        }
+        return words[node / kBitsPerWord] >> (node % kBitsPerWord) & 1;
+    }
+};
+
+// The nodes this process may allocate on; only node 0 if the kernel cannot tell.
+inline NodeMask ReadAllowedNodes() {
+    NodeMask mask;
+    if (syscall(SYS_get_mempolicy, nullptr, mask.words, kMaxNodes, nullptr, MPOL_F_MEMS_ALLOWED) !=
+        0) {
+        mask = NodeMask();
+        mask.words[0] = 1;
+    }
+    return mask;
+}
+
+inline const NodeMask& AllowedNodes() {
+    static const NodeMask kMask = ReadAllowedNodes();
+    return kMask;
+}
+
+inline int CountNodes() {
+    int count = 1;
+    for (int node = 0; node < kMaxNodes; ++node) {
+        if (AllowedNodes().Has(node)) {
+            count = node + 1;
+        }
+    }
+    return count;
+}
+
+}  // namespace detail
+
+// One more than the largest node id this process may allocate on. The ids below it need not all
+// be usable: a cpuset may allow nodes 0 and 2 only.
+inline int NodeCount() {
+    static const int kCount = detail::CountNodes();
+    return kCount;
+}
+
+// Whether this process may allocate on `node`.
+inline bool IsNodeAllowed(int node) {
+    return detail::AllowedNodes().Has(node);
+}
+
+// The node of the CPU the calling thread is running on right now.
+inline int CurrentNode() {
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+        return 0;
+    }
+    return static_cast<int>(node);
+}
+
+// Asks the kernel to take the pages of `[data, data + length)`, which must be page-aligned and
+// not yet touched, from `node`, falling back to other nodes when it runs out of memory. Returns
+// whether the policy was applied; always false on single-node machines.
+inline bool BindToNode(void* data, size_t length, int node) {
+    if (NodeCount() <= 1 || node < 0 || node >= NodeCount()) {
+        return false;
+    }
+    unsigned long mask[detail::kMaskWords] = {};
+    mask[node / detail::kBitsPerWord] = 1ul << (node % detail::kBitsPerWord);
+    return syscall(SYS_mbind, data, length, MPOL_PREFERRED, mask, kMaxNodes, 0) == 0;
+}
+
+// The node holding the page at `address` (faulting it in if needed), or -1 if unknown.
+inline int NodeOf(const void* address) {
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, address, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+        return -1;
+    }
+    return node;
+}
+
+}  // namespace numa
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+// Hash and comparison functors for the smart pointers of this project.
+//
+// Owner-based functors (`OwnerLess`, `OwnerHash`, `OwnerEqual`) use the `OwnerBefore`,
+// `OwnerHash` and `OwnerEqual` members, so a `SharedPtr` and a `WeakPtr` to the same object
+// (or aliasing pointers sharing one control block) are equivalent.
+//
+// Pointer-based functors (`PointerHash`, `PointerEqual`) use the stored pointer. They are
+// transparent and accept raw pointers as well: a set of smart pointers can be probed with a
+// `T*` without creating a temporary smart pointer and touching its reference count.
+
+template <typename P>
+const void* ToRawPointer(const P& ptr) noexcept {
+    if constexpr (std::is_pointer_v<P>) {
+        return ptr;
+    } else {
+        return ptr.Get();
+    }
+}
+
+struct OwnerLess {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& lhs, const B& rhs) const noexcept {
+        return lhs.OwnerBefore(rhs);
+    }
+};
+
+struct OwnerHash {
+    using is_transparent = void;
+
+    template <typename P>
+    size_t operator()(const P& ptr) const noexcept {
+        return ptr.OwnerHash();
+    }
+};
+
+struct OwnerEqual {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& lhs, const B& rhs) const noexcept {
+        return lhs.OwnerEqual(rhs);
+    }
+};
+
+struct PointerHash {
+    using is_transparent = void;
+
+    template <typename P>
+    size_t operator()(const P& ptr) const noexcept {
+        return std::hash<const void*>()(ToRawPointer(ptr));
+    }
+};
+
+struct PointerEqual {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& lhs, const B& rhs) const noexcept {
+        return ToRawPointer(lhs) == ToRawPointer(rhs);
+    }
+};
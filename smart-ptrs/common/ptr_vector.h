@@ -0,0 +1,282 @@
+#pragma once
+
+#include "relocatable.h"
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Vector of smart pointers (or any other type) which relocates trivially relocatable elements
+// with `memcpy`/`memmove`: growing, inserting and erasing move the bytes of the shifted elements
+// in one go, without touching any reference count or running any destructor. Other types fall
+// back to a move and a destructor call per element, as `std::vector` does.
+//
+// Destruction skips the destructor of empty smart pointers, so a mostly empty table is freed
+// without a call per slot.
+//
+// Iterators are plain pointers; like `std::vector`'s, they are invalidated by growth and by
+// insertions and erasures before them.
+template <typename P>
+class PtrVector {
+public:
+    PtrVector() = default;
+
+    PtrVector(const PtrVector& other) {
+        Reserve(other.size_);
+        try {
+            for (const P& element : other) {
+                new (data_ + size_) P(element);
+                ++size_;
+            }
+        } catch (...) {
+            Destroy(data_, data_ + size_);
+            Deallocate(data_, capacity_);
+            throw;
+        }
+    }
+
+    PtrVector(PtrVector&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    PtrVector& operator=(PtrVector other) noexcept {
+        Swap(other);
+        return *this;
+    }
+
+    ~PtrVector() {
+        Clear();
+        Deallocate(data_, capacity_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    P* Data() {
+        return data_;
+    }
+    const P* Data() const {
+        return data_;
+    }
+    size_t Size() const {
+        return size_;
+    }
+    size_t Capacity() const {
+        return capacity_;
+    }
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    P& operator[](size_t index) {
+        return data_[index];
+    }
+    const P& operator[](size_t index) const {
+        return data_[index];
+    }
+
+    P* begin() {
+        return data_;
+    }
+    const P* begin() const {
+        return data_;
+    }
+    P* end() {
+        return data_ + size_;
+    }
+    const P* end() const {
+        return data_ + size_;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Reserve(size_t capacity) {
+        if (capacity > capacity_) {
+            Reallocate(capacity);
+        }
+    }
+
+    template <typename... Args>
+    P& EmplaceBack(Args&&... args) {
+        if (size_ == capacity_) {
+            return GrowAndEmplaceBack(std::forward<Args>(args)...);
+        }
+        P* element = new (data_ + size_) P(std::forward<Args>(args)...);
+        ++size_;
+        return *element;
+    }
+
+    void PushBack(P value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() {
+        --size_;
+        data_[size_].~P();
+    }
+
+    // Inserts `value` before `position` and returns the new element.
+    P* Insert(P* position, P value) {
+        size_t index = position - data_;
+        if (size_ == capacity_) {
+            Reallocate(NextCapacity());
+        }
+        P* slot = data_ + index;
+        if constexpr (kIsTriviallyRelocatable<P>) {
+            std::memmove(static_cast<void*>(slot + 1), slot, (size_ - index) * sizeof(P));
+            new (slot) P(std::move(value));
+        } else if (index == size_) {
+            new (slot) P(std::move(value));
+        } else {
+            new (data_ + size_) P(std::move(data_[size_ - 1]));
+            for (P* element = data_ + size_ - 1; element != slot; --element) {
+                *element = std::move(*(element - 1));
+            }
+            *slot = std::move(value);
+        }
+        ++size_;
+        return slot;
+    }
+
+    // Erases `[first, last)` and returns the element which followed them.
+    P* Erase(P* first, P* last) {
+        if (first == last) {
+            return first;
+        }
+        P* old_end = end();
+        if constexpr (kIsTriviallyRelocatable<P>) {
+            Destroy(first, last);
+            std::memmove(static_cast<void*>(first), last, (old_end - last) * sizeof(P));
+        } else {
+            P* out = first;
+            for (P* element = last; element != old_end; ++element, ++out) {
+                *out = std::move(*element);
+            }
+            Destroy(out, old_end);
+        }
+        size_ -= last - first;
+        return first;
+    }
+
+    P* Erase(P* position) {
+        return Erase(position, position + 1);
+    }
+
+    void Clear() {
+        Destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    void Swap(PtrVector& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+private:
+    size_t NextCapacity() const {
+        return capacity_ == 0 ? 4 : 2 * capacity_;
+    }
+
+    static P* Allocate(size_t capacity) {
+        if (capacity > size_t(-1) / sizeof(P)) {
+            throw std::length_error("PtrVector: too many elements");
+        }
+        return static_cast<P*>(::operator new(capacity * sizeof(P)));
+    }
+
+    void Reallocate(size_t capacity) {
+        P* data = Allocate(capacity);
+        try {
+            MoveTo(data, capacity);
+        } catch (...) {
+            Deallocate(data, capacity);
+            throw;
+        }
+    }
+
+    // The arguments may refer to an element (`v.EmplaceBack(v[0])`), so the new element is
+    // constructed in the new buffer before the others move there and the old one is freed.
+    template <typename... Args>
+    P& GrowAndEmplaceBack(Args&&... args) {
+        size_t capacity = NextCapacity();
+        P* data = Allocate(capacity);
+        P* element = nullptr;
+        try {
+            element = new (data + size_) P(std::forward<Args>(args)...);
+            MoveTo(data, capacity);
+        } catch (...) {
+            if (element) {
+                element->~P();
+            }
+            Deallocate(data, capacity);
+            throw;
+        }
+        ++size_;
+        return *element;
+    }
+
+    // Moves the elements into `data`, which has room for `capacity` of them, and frees the old
+    // buffer. If a move throws, the elements moved so far are destroyed and nothing changes.
+    void MoveTo(P* data, size_t capacity) {
+        if constexpr (kIsTriviallyRelocatable<P>) {
+            if (size_ != 0) {
+                std::memcpy(static_cast<void*>(data), data_, size_ * sizeof(P));
+            }
+        } else {
+            size_t moved = 0;
+            try {
+                for (; moved < size_; ++moved) {
+                    new (data + moved) P(std::move_if_noexcept(data_[moved]));
+                }
+            } catch (...) {
+                Destroy(data, data + moved);
+                throw;
+            }
+            Destroy(data_, data_ + size_);
+        }
+        Deallocate(data_, capacity_);
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    static void Deallocate(P* data, size_t capacity) {
+        if (data) {
+            ::operator delete(data, capacity * sizeof(P));
+        }
+    }
+
+    // An empty smart pointer is all zero bytes and owns nothing: only the others need their
+    // destructors. Comparing the bytes (rather than `operator bool`) keeps an aliasing `SharedPtr`
+    // which stores null but owns a control block.
+    static bool IsEmpty(const P& element) {
+        static constexpr unsigned char kZeros[sizeof(P)] = {};
+        return std::memcmp(static_cast<const void*>(&element), kZeros, sizeof(P)) == 0;
+    }
+
+    static void Destroy(P* first, P* last) {
+        if constexpr (std::is_trivially_destructible_v<P>) {
+            return;
+        } else if constexpr (kIsTriviallyRelocatable<P>) {
+            for (P* element = first; element != last; ++element) {
+                if (!IsEmpty(*element)) {
+                    element->~P();
+                }
+            }
+        } else {
+            for (P* element = first; element != last; ++element) {
+                element->~P();
+            }
+        }
+    }
+
+    P* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <type_traits>
+
+// `IsTriviallyRelocatable<T>`: moving a `T` into fresh storage and destroying the source is the
+// same as copying its bytes and forgetting the source. Containers may then relocate elements
+// with `memcpy`/`memmove` instead of a move and a destructor call per element.
+//
+// It also promises that a value whose bytes are all zero, such as an empty smart pointer, owns
+// nothing, so its destructor may be skipped. Specialize it for other types which keep no
+// pointers into themselves.
+template <typename T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+// A reference member (e.g. a deleter held by reference) is a pointer in disguise.
+template <typename T>
+struct IsTriviallyRelocatable<T&> : std::true_type {};
+
+template <typename T>
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
+
+template <typename T, typename Deleter>
+class UniquePtr;
+
+template <typename T>
+class SharedPtr;
+
+template <typename T>
+class WeakPtr;
+
+template <typename T>
+class IntrusivePtr;
+
+// Only the deleter can hold state which is not just pointers: stateless and trivially copyable
+// deleters keep `UniquePtr` relocatable.
+template <typename T, typename Deleter>
+struct IsTriviallyRelocatable<UniquePtr<T, Deleter>>
+    : std::bool_constant<kIsTriviallyRelocatable<Deleter>> {};
+
+// Two plain pointers: the counters live in the control block, not in the pointer.
+template <typename T>
+struct IsTriviallyRelocatable<SharedPtr<T>> : std::true_type {};
+
+template <typename T>
+struct IsTriviallyRelocatable<WeakPtr<T>> : std::true_type {};
+
+template <typename T>
+struct IsTriviallyRelocatable<IntrusivePtr<T>> : std::true_type {};
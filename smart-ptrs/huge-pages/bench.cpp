@@ -0,0 +1,105 @@
+#include <common/huge_page_arena.h>
+#include <intrusive/huge_pages.h>
+#include <shared-from-this/huge_pages.h>
+
+#include <catch.hpp>
+
+#include <common/bench.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr size_t kNodes = 4'000'000;
+constexpr size_t kPasses = 3;
+
+struct SharedNode {
+    SharedPtr<SharedNode> next;
+    uint64_t value = 0;
+};
+
+template <typename Delete>
+struct IntrusiveNode : SimpleRefCounted<IntrusiveNode<Delete>, Delete> {
+    IntrusivePtr<IntrusiveNode> next;
+    uint64_t value = 0;
+};
+
+std::vector<size_t> ShuffledOrder() {
+    std::vector<size_t> order(kNodes);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+    return order;
+}
+
+// Allocates the nodes one after another, then links them in random order, so that following
+// `next` jumps all over the memory the nodes occupy and nearly every step misses the TLB.
+template <typename Ptr, typename Make>
+void ChasePointers(const char* name, Make make) {
+    static const std::vector<size_t> kOrder = ShuffledOrder();
+    std::vector<Ptr> nodes;
+    nodes.reserve(kNodes);
+    for (size_t i = 0; i < kNodes; ++i) {
+        nodes.push_back(make());
+        nodes.back()->value = i;
+    }
+    for (size_t i = 0; i + 1 < kNodes; ++i) {
+        nodes[kOrder[i]]->next = nodes[kOrder[i + 1]];
+    }
+    const auto* head = nodes[kOrder[0]].Get();
+
+    MeasureBatchNsPerOp(name, kNodes * kPasses, [head] {
+        uint64_t sum = 0;
+        for (size_t pass = 0; pass < kPasses; ++pass) {
+            for (auto* node = head; node; node = node->next.Get()) {
+                sum += node->value;
+            }
+        }
+        DoNotOptimize(sum);
+    });
+
+    // Unlink first: dropping the head would otherwise free the chain recursively.
+    for (Ptr& node : nodes) {
+        node->next = nullptr;
+    }
+}
+
+void PrintStats(const HugePageArena& arena) {
+    HugePageArena::Stats stats = arena.GetStats();
+    std::printf("  arena: %zu regions of 2 MB, %zu advised, %zu backed by huge pages\n",
+                stats.regions, stats.advised_regions, stats.huge_pages);
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("Pointer chasing", "[.][bench]") {
+    std::printf("one step along a shuffled linked list of %zu nodes:\n", kNodes);
+    {
+        ChasePointers<SharedPtr<SharedNode>>("MakeShared, heap",
+                                             [] { return MakeShared<SharedNode>(); });
+        HugePageArena arena;
+        ChasePointers<SharedPtr<SharedNode>>(
+            "MakeShared, huge page arena",
+            [&arena] { return MakeShared<SharedNode>(HugePages{arena}); });
+        PrintStats(arena);
+    }
+    {
+        using HeapNode = IntrusiveNode<DefaultDelete>;
+        using ArenaNode = IntrusiveNode<HugePageDelete>;
+        ChasePointers<IntrusivePtr<HeapNode>>("MakeIntrusive, heap",
+                                              [] { return MakeIntrusive<HeapNode>(); });
+        HugePageArena arena;
+        ChasePointers<IntrusivePtr<ArenaNode>>(
+            "MakeIntrusive, huge page arena",
+            [&arena] { return MakeIntrusive<ArenaNode>(HugePages{arena}); });
+        PrintStats(arena);
+    }
+}
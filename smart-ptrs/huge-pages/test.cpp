@@ -0,0 +1,144 @@
+#include <common/huge_page_arena.h>
+#include <common/my_int.h>
+#include <intrusive/huge_pages.h>
+#include <shared-from-this/huge_pages.h>
+#include <shared-from-this/weak.h>
+#include <unique/huge_pages.h>
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+bool IsInRegionOf(const void* ptr, const void* other) {
+    auto mask = ~(uintptr_t{HugePageArena::kRegionSize} - 1);
+    return (reinterpret_cast<uintptr_t>(ptr) & mask) == (reinterpret_cast<uintptr_t>(other) & mask);
+}
+
+struct Node : SimpleRefCounted<Node, HugePageDelete> {
+    explicit Node(int value) : value(value) {
+    }
+
+    int value;
+    MyInt payload;
+};
+
+struct Self : EnableSharedFromThis<Self> {
+    int value = 7;
+};
+
+struct Throwing {
+    Throwing() {
+        throw std::runtime_error("constructor");
+    }
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("HugePageArena") {
+    HugePageArena arena;
+
+    SECTION("Size classes and alignment") {
+        for (size_t size : {1, 8, 16, 17, 40, 100, 1000, 5000, 16384}) {
+            for (size_t align : {1, 8, 16, 32, 64}) {
+                void* ptr = arena.Allocate(size, align);
+                REQUIRE(reinterpret_cast<uintptr_t>(ptr) % align == 0);
+                HugePageArena::Deallocate(ptr);
+            }
+        }
+        REQUIRE_THROWS_AS(arena.Allocate(8, 128), std::invalid_argument);
+    }
+
+    SECTION("Freed blocks are reused") {
+        void* first = arena.Allocate(24);
+        HugePageArena::Deallocate(first);
+        REQUIRE(arena.Allocate(24) == first);
+    }
+
+    SECTION("Regions are aligned and counted") {
+        std::vector<void*> blocks;
+        for (size_t i = 0; i < 3 * HugePageArena::kRegionSize / 1024; ++i) {
+            blocks.push_back(arena.Allocate(1024));
+        }
+        for (void* block : blocks) {
+            HugePageArena::Deallocate(block);
+        }
+        HugePageArena::Stats stats = arena.GetStats();
+        REQUIRE(stats.regions == 4);
+        REQUIRE(stats.reserved_bytes == 4 * HugePageArena::kRegionSize);
+        REQUIRE(stats.advised_regions <= stats.regions);
+        REQUIRE(stats.huge_pages <= stats.regions);
+    }
+
+    SECTION("Large blocks get their own mapping") {
+        void* large = arena.Allocate(3 * HugePageArena::kRegionSize);
+        static_cast<char*>(large)[3 * HugePageArena::kRegionSize - 1] = 1;
+        REQUIRE(arena.GetStats().regions == 4);
+        HugePageArena::Deallocate(large);
+        REQUIRE(arena.GetStats().regions == 0);
+    }
+
+    SECTION("Sizes which cannot be mapped") {
+        REQUIRE_THROWS_AS(arena.Allocate(SIZE_MAX), std::bad_alloc);
+        REQUIRE_THROWS_AS(arena.Allocate(SIZE_MAX - HugePageArena::kRegionSize), std::bad_alloc);
+        REQUIRE(arena.GetStats().regions == 0);
+    }
+}
+
+TEST_CASE("Placement in a huge page arena") {
+    HugePageArena arena;
+    HugePages place{arena};
+
+    SECTION("MakeShared") {
+        {
+            auto first = MakeShared<MyInt>(place, 1);
+            auto second = MakeShared<MyInt>(place, 2);
+            REQUIRE(*first == 1);
+            REQUIRE(*second == 2);
+            REQUIRE(IsInRegionOf(first.Get(), second.Get()));
+            REQUIRE(MyInt::AliveCount() == 2);
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+
+        auto self = MakeShared<Self>(place);
+        SharedPtr<Self> other = self->SharedFromThis();
+        WeakPtr<Self> weak = other;
+        REQUIRE(self.UseCount() == 2);
+        self.Reset();
+        other.Reset();
+        REQUIRE(weak.Expired());
+    }
+
+    SECTION("MakeIntrusive") {
+        {
+            auto node = MakeIntrusive<Node>(place, 5);
+            IntrusivePtr<Node> copy = node;
+            REQUIRE(copy->value == 5);
+            REQUIRE(node->RefCount() == 2);
+            REQUIRE(MyInt::AliveCount() == 1);
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+
+    SECTION("MakeUnique") {
+        static_assert(sizeof(HugePageUniquePtr<MyInt>) == sizeof(void*));
+        {
+            auto value = MakeUnique<MyInt>(place, 3);
+            REQUIRE(*value == 3);
+            REQUIRE(MyInt::AliveCount() == 1);
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+
+    SECTION("Constructor throws") {
+        REQUIRE_THROWS_AS(MakeShared<Throwing>(place), std::runtime_error);
+        REQUIRE_THROWS_AS(MakeUnique<Throwing>(place), std::runtime_error);
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <atomic>     // for std::atomic
+#include <cstdint>    // for uintptr_t
+#include <stdexcept>  // for std::invalid_argument
+
+// Slot holding an `IntrusivePtr<T>` which threads may load and replace concurrently.
+//
+// A plain load followed by `IncRef` races with a writer dropping the last reference in between.
+// Here a reader first borrows a reference: it increments a count kept in the top 16 bits of the
+// slot word (user-space pointers fit in 48 bits on x86-64 and AArch64), which is enough to keep
+// the object alive. It then takes a real reference and returns the borrowed one by decrementing
+// the same count, as long as the slot still holds that object. A writer which replaces the
+// object converts the borrowed references left in the word into real ones, and a reader which
+// finds its borrowed count gone drops a real reference instead. Every operation is a handful of
+// atomic instructions on one word, without locks.
+//
+// `T` must use a thread-safe counter. At most 65535 loads may be in flight at the same time.
+// Pointers with any of the top 16 bits set, such as AArch64 tagged pointers (TBI, MTE) or
+// addresses from a 57-bit address space (LA57), are rejected with `std::invalid_argument`.
+template <typename T>
+class AtomicIntrusivePtr {
+    static_assert(sizeof(uintptr_t) == 8, "AtomicIntrusivePtr needs 64-bit pointers");
+    static_assert(std::atomic<uintptr_t>::is_always_lock_free);
+    static_assert(T::kThreadSafeCount, "AtomicIntrusivePtr needs a thread-safe counter");
+
+    static constexpr int kPointerBits = 48;
+    static constexpr uintptr_t kPointerMask = (uintptr_t{1} << kPointerBits) - 1;
+    static constexpr uintptr_t kOneBorrowed = uintptr_t{1} << kPointerBits;
+
+public:
+    AtomicIntrusivePtr() = default;
+
+    AtomicIntrusivePtr(IntrusivePtr<T> ptr) : state_(Pack(ptr.Get())) {
+        ptr.Release();
+    }
+
+    AtomicIntrusivePtr(const AtomicIntrusivePtr&) = delete;
+    AtomicIntrusivePtr& operator=(const AtomicIntrusivePtr&) = delete;
+
+    ~AtomicIntrusivePtr() {
+        if (T* ptr = GetPointer(state_.load(std::memory_order_acquire))) {
+            ptr->DecRef();
+        }
+    }
+
+    IntrusivePtr<T> Load() const {
+        if (!GetPointer(state_.load(std::memory_order_relaxed))) {
+            return IntrusivePtr<T>();
+        }
+        uintptr_t state = state_.fetch_add(kOneBorrowed, std::memory_order_acquire) + kOneBorrowed;
+        T* ptr = GetPointer(state);
+        if (!ptr) {
+            ReturnBorrowed(state, ptr);
+            return IntrusivePtr<T>();
+        }
+        IntrusivePtr<T> result;
+        ptr->IncRef();
+        result.ptr_ = ptr;
+        ReturnBorrowed(state, ptr);
+        return result;
+    }
+
+    void Store(IntrusivePtr<T> desired) {
+        Exchange(std::move(desired));
+    }
+
+    IntrusivePtr<T> Exchange(IntrusivePtr<T> desired) {
+        uintptr_t previous = state_.exchange(Pack(desired.Get()), std::memory_order_acq_rel);
+        desired.Release();
+        return Adopt(previous);
+    }
+
+    // Replaces the value with `desired` if it is `expected`. Otherwise loads the current value
+    // into `expected`; by then the slot may have changed again.
+    bool CompareExchange(IntrusivePtr<T>& expected, IntrusivePtr<T> desired) {
+        uintptr_t packed = Pack(desired.Get());
+        uintptr_t state = state_.load(std::memory_order_relaxed);
+        while (GetPointer(state) == expected.Get()) {
+            // A failure here may be a concurrent load changing the borrowed count only.
+            if (state_.compare_exchange_weak(state, packed,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_relaxed)) {
+                desired.Release();
+                Adopt(state);
+                return true;
+            }
+        }
+        expected = Load();
+        return false;
+    }
+
+    static constexpr bool IsLockFree() {
+        return true;
+    }
+
+private:
+    // The top bits hold the borrowed count, so a pointer using them would corrupt it.
+    static uintptr_t Pack(T* ptr) {
+        uintptr_t word = reinterpret_cast<uintptr_t>(ptr);
+        if ((word & ~kPointerMask) != 0) {
+            throw std::invalid_argument("AtomicIntrusivePtr: pointer does not fit in 48 bits");
+        }
+        return word;
+    }
+
+    static T* GetPointer(uintptr_t state) {
+        return reinterpret_cast<T*>(state & kPointerMask);
+    }
+
+    // Takes over the slot's reference from a replaced word, converting the borrowed ones.
+    static IntrusivePtr<T> Adopt(uintptr_t state) {
+        IntrusivePtr<T> result;
+        result.ptr_ = GetPointer(state);
+        if (result.ptr_) {
+            for (uintptr_t borrowed = state >> kPointerBits; borrowed != 0; --borrowed) {
+                result.ptr_->IncRef();
+            }
+        }
+        return result;
+    }
+
+    // Gives back the reference borrowed by `Load`. Borrowed references to the same object are
+    // interchangeable, so any nonzero count of the current word may be decremented.
+    void ReturnBorrowed(uintptr_t state, T* ptr) const {
+        while (GetPointer(state) == ptr && (state >> kPointerBits) != 0) {
+            if (state_.compare_exchange_weak(state, state - kOneBorrowed,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        // A writer has converted the borrowed reference into a real one.
+        if (ptr) {
+            ptr->DecRef();
+        }
+    }
+
+    mutable std::atomic<uintptr_t> state_ = 0;
+};
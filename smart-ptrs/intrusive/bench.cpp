@@ -0,0 +1,262 @@
+#include "intrusive.h"
+#include "atomic_intrusive.h"
+#include "magazine_pool.h"
+
+#include <shared-from-this/shared.h>
+
+#include <catch.hpp>
+
+#include <common/bench.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Payload : ThreadSafeRefCounted<Payload> {
+    int value = 0;
+};
+
+struct SimplePayload : SimpleRefCounted<SimplePayload> {
+    int value = 0;
+};
+
+struct PlainPayload {
+    int value = 0;
+};
+
+constexpr size_t kIterations = 2'000'000;
+
+// Every thread copies and drops its own handle to one shared object, so all of them hammer the
+// same counter.
+template <typename Ptr>
+void HammerCounter(const char* name, const Ptr& shared, size_t num_threads) {
+    MeasureBatchNsPerOp(name, kIterations * num_threads, [&] {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&shared] {
+                for (size_t i = 0; i < kIterations; ++i) {
+                    Ptr copy = shared;
+                    DoNotOptimize(copy);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+}
+
+// The design of the original test pool: a vector of idle objects, here behind a mutex.
+template <typename T>
+class LockedPool {
+public:
+    ~LockedPool() {
+        for (T* object : objects_) {
+            delete object;
+        }
+    }
+
+    IntrusivePtr<T> Allocate() {
+        {
+            std::lock_guard lock(mutex_);
+            if (!objects_.empty()) {
+                T* object = objects_.back();
+                objects_.pop_back();
+                return IntrusivePtr<T>(object);
+            }
+        }
+        T* object = new T();
+        object->home_ = this;
+        return IntrusivePtr<T>(object);
+    }
+
+    void Release(T* object) {
+        std::lock_guard lock(mutex_);
+        objects_.push_back(object);
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<T*> objects_;
+};
+
+struct LockedMessage : ObjectInPool<LockedMessage, ThreadSafeCounter, LockedPool<LockedMessage>> {
+    int value = 0;
+};
+
+struct PooledMessage : ObjectInMagazinePool<PooledMessage> {
+    int value = 0;
+};
+
+// Single-producer single-consumer ring of raw pointers which carry their reference along.
+template <typename T>
+class Channel {
+public:
+    void Send(IntrusivePtr<T> message) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        while (tail - head_.load(std::memory_order_acquire) == kSize) {
+            std::this_thread::yield();
+        }
+        slots_[tail % kSize] = message.Release();
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    T* Receive() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        while (tail_.load(std::memory_order_acquire) == head) {
+            std::this_thread::yield();
+        }
+        T* message = slots_[head % kSize];
+        head_.store(head + 1, std::memory_order_release);
+        return message;
+    }
+
+private:
+    static constexpr size_t kSize = 1024;
+
+    T* slots_[kSize];
+    std::atomic<size_t> head_ = 0;
+    std::atomic<size_t> tail_ = 0;
+};
+
+// `num_pairs` producers allocate messages and pass them to their consumers, which drop them.
+template <typename Message, typename Pool>
+void ProducerConsumer(const char* name, Pool& pool, size_t num_pairs) {
+    constexpr size_t kMessages = 1'000'000;
+    MeasureBatchNsPerOp(name, kMessages * num_pairs, [&] {
+        std::vector<Channel<Message>> channels(num_pairs);
+        std::vector<std::thread> threads;
+        for (size_t pair = 0; pair < num_pairs; ++pair) {
+            Channel<Message>& channel = channels[pair];
+            threads.emplace_back([&pool, &channel] {
+                for (size_t i = 0; i < kMessages; ++i) {
+                    IntrusivePtr<Message> message = pool.Allocate();
+                    message->value = static_cast<int>(i);
+                    channel.Send(std::move(message));
+                }
+            });
+            threads.emplace_back([&channel] {
+                for (size_t i = 0; i < kMessages; ++i) {
+                    Message* message = channel.Receive();
+                    DoNotOptimize(message->value);
+                    message->DecRef();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+}
+
+// `IntrusivePtr` slot behind a mutex, the baseline for `AtomicIntrusivePtr`.
+template <typename T>
+class LockedSlot {
+public:
+    explicit LockedSlot(IntrusivePtr<T> ptr) : ptr_(std::move(ptr)) {
+    }
+
+    IntrusivePtr<T> Load() const {
+        std::lock_guard lock(mutex_);
+        return ptr_;
+    }
+
+    void Store(IntrusivePtr<T> ptr) {
+        std::lock_guard lock(mutex_);
+        ptr_.Swap(ptr);
+    }
+
+private:
+    mutable std::mutex mutex_;
+    IntrusivePtr<T> ptr_;
+};
+
+// `num_readers` threads load the slot while one writer replaces its value every 64 loads.
+template <typename Slot>
+void ReadMostly(const char* name, Slot& slot, size_t num_readers) {
+    constexpr size_t kLoads = 1'000'000;
+    MeasureBatchNsPerOp(name, kLoads * num_readers, [&] {
+        std::atomic<bool> done = false;
+        std::thread writer([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                slot.Store(MakeIntrusive<Payload>());
+                for (size_t j = 0; j < 64 && !done.load(std::memory_order_relaxed); ++j) {
+                    DoNotOptimize(slot.Load());
+                }
+            }
+        });
+        std::vector<std::thread> readers;
+        for (size_t t = 0; t < num_readers; ++t) {
+            readers.emplace_back([&slot] {
+                for (size_t i = 0; i < kLoads; ++i) {
+                    IntrusivePtr<Payload> value = slot.Load();
+                    DoNotOptimize(value->value);
+                }
+            });
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        done = true;
+        writer.join();
+    });
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("Counter contention", "[.][bench]") {
+    auto intrusive = MakeIntrusive<Payload>();
+    auto simple = MakeIntrusive<SimplePayload>();
+    auto shared = MakeShared<PlainPayload>();
+    static Payload immortal_payload;
+    immortal_payload.MakeImmortal();
+    IntrusivePtr<Payload> immortal_intrusive(&immortal_payload);
+    static SharedPtr<PlainPayload>& immortal_shared =
+        *new SharedPtr<PlainPayload>(MakeImmortalShared<PlainPayload>());
+
+    std::printf("copy + drop of one handle:\n");
+    HammerCounter("IntrusivePtr<SimpleRefCounted>, 1 thread", simple, 1);
+    HammerCounter("IntrusivePtr<ThreadSafeRefCounted>, 1 thread", intrusive, 1);
+    HammerCounter("SharedPtr, 1 thread", shared, 1);
+    for (size_t threads : {2, 4, 8}) {
+        std::printf("-- %zu threads\n", threads);
+        HammerCounter("IntrusivePtr<ThreadSafeRefCounted>", intrusive, threads);
+        HammerCounter("SharedPtr", shared, threads);
+        HammerCounter("IntrusivePtr to an immortal object", immortal_intrusive, threads);
+        HammerCounter("SharedPtr from MakeImmortalShared", immortal_shared, threads);
+    }
+
+    REQUIRE(intrusive.UseCount() == 1);
+    REQUIRE(shared.UseCount() == 1);
+}
+
+TEST_CASE("Pool producer/consumer", "[.][bench]") {
+    LockedPool<LockedMessage> locked;
+    MagazinePool<PooledMessage> magazines;
+
+    std::printf("allocate, hand over to another thread, release there:\n");
+    for (size_t pairs : {1, 2, 4}) {
+        std::printf("-- %zu producer/consumer pairs\n", pairs);
+        ProducerConsumer<LockedMessage>("vector + mutex pool", locked, pairs);
+        ProducerConsumer<PooledMessage>("MagazinePool", magazines, pairs);
+    }
+}
+
+TEST_CASE("Atomic slot read-mostly", "[.][bench]") {
+    LockedSlot<Payload> locked(MakeIntrusive<Payload>());
+    AtomicIntrusivePtr<Payload> atomic(MakeIntrusive<Payload>());
+
+    std::printf("Load of a slot which another thread keeps replacing:\n");
+    for (size_t readers : {1, 2, 4}) {
+        std::printf("-- %zu readers\n", readers);
+        ReadMostly("mutex + IntrusivePtr", locked, readers);
+        ReadMostly("AtomicIntrusivePtr", atomic, readers);
+    }
+}
@@ -0,0 +1,222 @@
+#include "persistent_map.h"
+#include "persistent_vector.h"
+
+#include <catch.hpp>
+
+#include <common/bench.h>
+
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <malloc.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr size_t kElements = 100'000;
+constexpr size_t kUpdates = 100'000;
+// Deep copies are slow enough that fewer of them make a stable measurement.
+constexpr size_t kCopies = 1'000;
+constexpr size_t kLookups = 10'000'000;
+
+constexpr size_t kVersions = 1'000;
+constexpr size_t kVersionElements = 2'000;
+
+// Random keys below `bound`, drawn up front so the generator stays out of the measurements.
+std::vector<size_t> RandomKeys(size_t count, size_t bound) {
+    std::mt19937_64 gen(42);
+    std::vector<size_t> keys(count);
+    for (size_t& key : keys) {
+        key = gen() % bound;
+    }
+    return keys;
+}
+
+PersistentVector<int> MakePersistentVector(size_t size) {
+    PersistentVector<int> vector;
+    for (size_t i = 0; i < size; ++i) {
+        vector = std::move(vector).PushBack(int(i));
+    }
+    return vector;
+}
+
+PersistentHashMap<int, int> MakePersistentMap(size_t size) {
+    PersistentHashMap<int, int> map;
+    for (size_t i = 0; i < size; ++i) {
+        map = std::move(map).Set(int(i), int(i));
+    }
+    return map;
+}
+
+std::unordered_map<int, int> MakeStdMap(size_t size) {
+    std::unordered_map<int, int> map;
+    for (size_t i = 0; i < size; ++i) {
+        map.emplace(int(i), int(i));
+    }
+    return map;
+}
+
+// Bytes in use on the heap of the calling thread.
+size_t HeapInUse() {
+    return mallinfo2().uordblks;
+}
+
+// Keeps `kVersions` versions, each one update away from the previous, and prints what all but the
+// first one take.
+template <typename Container, typename Update>
+void MeasureVersions(const char* name, Container first, Update update) {
+    auto keys = RandomKeys(kVersions, kVersionElements);
+    size_t before = HeapInUse();
+    std::vector<Container> versions;
+    versions.reserve(kVersions);
+    versions.push_back(std::move(first));
+    for (size_t i = 1; i < kVersions; ++i) {
+        versions.push_back(update(versions.back(), keys[i]));
+    }
+    double bytes = double(HeapInUse() - before);
+    std::printf("%-56s %10.2f MB (%.0f bytes per version)\n", name, bytes / (1 << 20),
+                bytes / (kVersions - 1));
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("Persistent vector", "[.][bench]") {
+    auto keys = RandomKeys(kUpdates, kElements);
+
+    std::printf("set a random element of a %zu-element vector:\n", kElements);
+    MeasureBatchNsPerOp("std::vector, copied for every version", kCopies, [&] {
+        std::vector<int> vector(kElements);
+        for (size_t i = 0; i < kCopies; ++i) {
+            std::vector<int> next = vector;
+            next[keys[i]] = int(i);
+            vector = std::move(next);
+        }
+        DoNotOptimize(vector.data());
+    });
+    MeasureBatchNsPerOp("PersistentVector, path copied for every version", kUpdates, [&] {
+        auto vector = MakePersistentVector(kElements);
+        auto previous = vector;
+        for (size_t i = 0; i < kUpdates; ++i) {
+            previous = vector;
+            vector = vector.Set(keys[i], int(i));
+        }
+        DoNotOptimize(previous.Size());
+    });
+    MeasureBatchNsPerOp("PersistentVector, transient", kUpdates, [&] {
+        auto vector = MakePersistentVector(kElements);
+        for (size_t i = 0; i < kUpdates; ++i) {
+            vector = std::move(vector).Set(keys[i], int(i));
+        }
+        DoNotOptimize(vector.Size());
+    });
+    MeasureBatchNsPerOp("std::vector, in place", kUpdates, [&] {
+        std::vector<int> vector(kElements);
+        for (size_t i = 0; i < kUpdates; ++i) {
+            vector[keys[i]] = int(i);
+        }
+        DoNotOptimize(vector.data());
+    });
+
+    auto lookups = RandomKeys(kLookups, kElements);
+    std::printf("read a random element of a %zu-element vector:\n", kElements);
+    {
+        std::vector<int> vector(kElements);
+        MeasureBatchNsPerOp("std::vector", kLookups, [&] {
+            for (size_t key : lookups) {
+                DoNotOptimize(vector[key]);
+            }
+        });
+        auto persistent = MakePersistentVector(kElements);
+        MeasureBatchNsPerOp("PersistentVector", kLookups, [&] {
+            for (size_t key : lookups) {
+                DoNotOptimize(persistent[key]);
+            }
+        });
+    }
+
+    std::printf("keep %zu versions of a %zu-element vector, one update apart:\n", kVersions,
+                kVersionElements);
+    MeasureVersions("std::vector copies", std::vector<int>(kVersionElements),
+                    [](const std::vector<int>& previous, size_t key) {
+                        std::vector<int> next = previous;
+                        next[key] = -1;
+                        return next;
+                    });
+    MeasureVersions("PersistentVector versions", MakePersistentVector(kVersionElements),
+                    [](const PersistentVector<int>& previous, size_t key) {
+                        return previous.Set(key, -1);
+                    });
+}
+
+TEST_CASE("Persistent hash map", "[.][bench]") {
+    auto keys = RandomKeys(kUpdates, kElements);
+
+    std::printf("assign to a random key of a %zu-entry map:\n", kElements);
+    MeasureBatchNsPerOp("std::unordered_map, copied for every version", kCopies / 10, [&] {
+        auto map = MakeStdMap(kElements);
+        for (size_t i = 0; i < kCopies / 10; ++i) {
+            auto next = map;
+            next[int(keys[i])] = int(i);
+            map = std::move(next);
+        }
+        DoNotOptimize(map.size());
+    });
+    MeasureBatchNsPerOp("PersistentHashMap, path copied for every version", kUpdates, [&] {
+        auto map = MakePersistentMap(kElements);
+        auto previous = map;
+        for (size_t i = 0; i < kUpdates; ++i) {
+            previous = map;
+            map = map.Set(int(keys[i]), int(i));
+        }
+        DoNotOptimize(previous.Size());
+    });
+    MeasureBatchNsPerOp("PersistentHashMap, transient", kUpdates, [&] {
+        auto map = MakePersistentMap(kElements);
+        for (size_t i = 0; i < kUpdates; ++i) {
+            map = std::move(map).Set(int(keys[i]), int(i));
+        }
+        DoNotOptimize(map.Size());
+    });
+    MeasureBatchNsPerOp("std::unordered_map, in place", kUpdates, [&] {
+        auto map = MakeStdMap(kElements);
+        for (size_t i = 0; i < kUpdates; ++i) {
+            map[int(keys[i])] = int(i);
+        }
+        DoNotOptimize(map.size());
+    });
+
+    auto lookups = RandomKeys(kLookups, kElements);
+    std::printf("find a random key of a %zu-entry map:\n", kElements);
+    {
+        auto map = MakeStdMap(kElements);
+        MeasureBatchNsPerOp("std::unordered_map", kLookups, [&] {
+            for (size_t key : lookups) {
+                DoNotOptimize(map.find(int(key))->second);
+            }
+        });
+        auto persistent = MakePersistentMap(kElements);
+        MeasureBatchNsPerOp("PersistentHashMap", kLookups, [&] {
+            for (size_t key : lookups) {
+                DoNotOptimize(*persistent.Find(int(key)));
+            }
+        });
+    }
+
+    std::printf("keep %zu versions of a %zu-entry map, one update apart:\n", kVersions,
+                kVersionElements);
+    MeasureVersions("std::unordered_map copies", MakeStdMap(kVersionElements),
+                    [](const std::unordered_map<int, int>& previous, size_t key) {
+                        auto next = previous;
+                        next[int(key)] = -1;
+                        return next;
+                    });
+    MeasureVersions("PersistentHashMap versions", MakePersistentMap(kVersionElements),
+                    [](const PersistentHashMap<int, int>& previous, size_t key) {
+                        return previous.Set(int(key), -1);
+                    });
+}
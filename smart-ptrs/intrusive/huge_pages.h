@@ -0,0 +1,33 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <common/huge_page_arena.h>
+
+#include <new>      // for placement new
+#include <utility>  // for std::forward
+
+// Deleter policy for objects created by `MakeIntrusive<T>(HugePages{arena}, ...)`:
+//
+//     class Node : public SimpleRefCounted<Node, HugePageDelete> { ... };
+struct HugePageDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        object->~T();
+        HugePageArena::Deallocate(object);
+    }
+};
+
+// Constructs `T` in `arena`. `T` must be destroyed with `HugePageDelete`.
+template <typename T, typename... Args>
+IntrusivePtr<T> MakeIntrusive(HugePages place, Args&&... args) {
+    void* memory = place.arena.Allocate(sizeof(T), alignof(T));
+    T* object;
+    try {
+        object = new (memory) T(std::forward<Args>(args)...);
+    } catch (...) {
+        HugePageArena::Deallocate(memory);
+        throw;
+    }
+    return IntrusivePtr<T>(object);
+}
@@ -1,29 +1,150 @@
 #pragma once
 
-#include <cstddef>  // for std::nullptr_t
-#include <utility>  // for std::exchange / std::swap
+#include <atomic>       // for std::atomic / std::atomic_thread_fence
+#include <cstddef>      // for std::nullptr_t
+#include <functional>   // for std::hash / std::less
+#include <limits>       // for std::numeric_limits
+#include <type_traits>  // for std::is_unsigned_v
+#include <utility>      // for std::exchange / std::swap
+
+// Counters take the integer type of the count as a parameter: a `uint16_t` or `uint32_t` count
+// saves space in small objects.
+//
+// A count with the top bit set is immortal: `IncRef` and `DecRef` neither write it nor ever reach
+// zero. `MakeImmortal` puts an object (e.g. a static or an interned one shared by every thread)
+// into this state, and a count which overflows into it saturates there instead of wrapping
+// around, leaking the object rather than destroying it while still in use. Immortal counts sit
+// in the middle of the range, so racing increments and decrements of a thread-safe counter
+// cannot leave it: the increment which overflows onto `kImmortalBit` itself moves the count
+// there, undoing any decrement which raced it back below the bit.
+template <typename Count>
+struct CounterTraits {
+    static_assert(std::is_unsigned_v<Count>, "Counts must be unsigned");
+
+    static constexpr Count kImmortalBit = std::numeric_limits<Count>::max() / 2 + 1;
+    static constexpr Count kImmortal = Count(kImmortalBit | kImmortalBit / 2);
+
+    static bool IsImmortal(Count count) {
+        return (count & kImmortalBit) != 0;
+    }
+};
+
+template <typename Count = size_t>
+class BasicSimpleCounter {
+    using Traits = CounterTraits<Count>;
 
-class SimpleCounter {
 public:
+    static constexpr bool kThreadSafe = false;
+
     size_t IncRef() {
-        ++count_;
+        if (!Traits::IsImmortal(count_)) {
+            ++count_;
+        }
         return count_;
     };
+    // Must not be called on a zero counter: every `DecRef` pairs with an earlier `IncRef`.
     size_t DecRef() {
-        if (count_ == 0) {
-            return count_;
+        if (!Traits::IsImmortal(count_)) {
+            --count_;
         }
-        --count_;
         return count_;
     };
+    // Takes a reference only if there is one already (`IntrusiveWeakPtr::Lock`).
+    bool IncRefIfNotZero() {
+        if (count_ == 0) {
+            return false;
+        }
+        IncRef();
+        return true;
+    };
     size_t RefCount() const {
         return count_;
     };
+    void MakeImmortal() {
+        count_ = Traits::kImmortal;
+    };
+    bool IsImmortal() const {
+        return Traits::IsImmortal(count_);
+    };
+
+private:
+    Count count_ = 0;
+};
+
+// Counter for objects shared between threads.
+// A new reference is always taken through an existing one, so the increment needs no ordering.
+// The decrement releases this thread's writes to the object, and the thread which drops the
+// last reference acquires all of them before the object is destroyed.
+// An immortal count is only read, so its cache line stays shared between all cores.
+template <typename Count = size_t>
+class BasicThreadSafeCounter {
+    using Traits = CounterTraits<Count>;
+
+public:
+    static constexpr bool kThreadSafe = true;
+
+    size_t IncRef() {
+        Count count = count_.load(std::memory_order_relaxed);
+        if (Traits::IsImmortal(count)) {
+            return count;
+        }
+        count = Count(count_.fetch_add(1, std::memory_order_relaxed) + 1);
+        if (count == Traits::kImmortalBit) {
+            Saturate();
+            return Traits::kImmortal;
+        }
+        return count;
+    };
+    size_t DecRef() {
+        Count count = count_.load(std::memory_order_relaxed);
+        if (Traits::IsImmortal(count)) {
+            return count;
+        }
+        count = Count(count_.fetch_sub(1, std::memory_order_release) - 1);
+        if (count == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return count;
+    };
+    bool IncRefIfNotZero() {
+        Count count = count_.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (Traits::IsImmortal(count)) {
+                return true;
+            }
+            if (count_.compare_exchange_weak(count, Count(count + 1), std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+                if (Count(count + 1) == Traits::kImmortalBit) {
+                    Saturate();
+                }
+                return true;
+            }
+        }
+        return false;
+    };
+    size_t RefCount() const {
+        return count_.load(std::memory_order_relaxed);
+    };
+    void MakeImmortal() {
+        count_.store(Traits::kImmortal, std::memory_order_relaxed);
+    };
+    bool IsImmortal() const {
+        return Traits::IsImmortal(count_.load(std::memory_order_relaxed));
+    };
 
 private:
-    size_t count_ = 0;
+    // The count reached `kImmortalBit`, where a decrement which loaded it just below the bit
+    // could still take it back into the mortal range: the object leaks from now on.
+    void Saturate() {
+        count_.store(Traits::kImmortal, std::memory_order_relaxed);
+    }
+
+    std::atomic<Count> count_ = 0;
 };
 
+using SimpleCounter = BasicSimpleCounter<size_t>;
+using ThreadSafeCounter = BasicThreadSafeCounter<size_t>;
+
 struct DefaultDelete {
     template <typename T>
     static void Destroy(T* object) {
@@ -34,6 +155,19 @@ struct DefaultDelete {
 template <typename Derived, typename Counter, typename Deleter>
 class RefCounted {
 public:
+    // Whether references may be taken and dropped from several threads at once.
+    static constexpr bool kThreadSafeCount = Counter::kThreadSafe;
+
+    RefCounted() = default;
+
+    // A copy is a new object: it starts with its own counter instead of the source's one.
+    RefCounted(const RefCounted&) {
+    }
+
+    RefCounted& operator=(const RefCounted&) {
+        return *this;
+    }
+
     // Increase reference counter.
     void IncRef() {
         static_cast<Derived*>(this)->counter_.IncRef();
@@ -54,26 +188,51 @@ public:
         // counter_.RefCount();
     };
 
-private:
+    // From now on references are not counted and the object is never destroyed.
+    // Meant for objects which outlive every reference, such as statics.
+    void MakeImmortal() {
+        static_cast<Derived*>(this)->counter_.MakeImmortal();
+    };
+
+    bool IsImmortal() const {
+        return static_cast<const Derived*>(this)->counter_.IsImmortal();
+    };
+
+protected:
     Counter counter_;
 };
 
 template <typename Derived, typename D = DefaultDelete>
 using SimpleRefCounted = RefCounted<Derived, SimpleCounter, D>;
 
+template <typename Derived, typename D = DefaultDelete>
+using ThreadSafeRefCounted = RefCounted<Derived, ThreadSafeCounter, D>;
+
+template <typename T>
+class IntrusiveWeakPtr;
+
+template <typename T>
+class AtomicIntrusivePtr;
+
 template <typename T>
 class IntrusivePtr {
     T* ptr_;
     template <typename Y>
     friend class IntrusivePtr;
 
+    template <typename Y>
+    friend class IntrusiveWeakPtr;
+
+    template <typename Y>
+    friend class AtomicIntrusivePtr;
+
     template <typename Y, typename... Args>
     friend IntrusivePtr<Y> MakeIntrusive(Args&&... args);
 
 public:
     // Constructors
-    IntrusivePtr() : ptr_(nullptr){};
-    IntrusivePtr(std::nullptr_t) : ptr_(nullptr){};
+    constexpr IntrusivePtr() : ptr_(nullptr){};
+    constexpr IntrusivePtr(std::nullptr_t) : ptr_(nullptr){};
     IntrusivePtr(T* ptr) : ptr_(ptr) {
         if (ptr_) {
             ptr_->IncRef();
@@ -110,20 +269,20 @@ public:
     };
     IntrusivePtr& operator=(IntrusivePtr&& other) {
         if (ptr_ != other.ptr_) {
-            Reset(other.Release());
+            IntrusivePtr{std::move(other)}.Swap(*this);
         }
         return *this;
     };
 
     // Destructor
-    ~IntrusivePtr() {
+    constexpr ~IntrusivePtr() {
         if (ptr_) {
             ptr_->DecRef();
         }
     };
 
     // Modifiers
-    void Reset() {
+    constexpr void Reset() {
         // IntrusivePtr{}.Swap(*this);
         if (ptr_) {
             ptr_->DecRef();
@@ -135,6 +294,9 @@ public:
         if (ptr_ != ptr) {
             Reset();
             ptr_ = ptr;
+            if (ptr_) {
+                ptr_->IncRef();
+            }
         }
     };
 
@@ -148,21 +310,54 @@ public:
     };
 
     // Observers
-    T* Get() const {
+    constexpr T* Get() const {
         return ptr_;
     };
-    T& operator*() const {
+    constexpr T& operator*() const {
         return *ptr_;
     };
-    T* operator->() const {
+    constexpr T* operator->() const {
         return ptr_;
     };
     size_t UseCount() const {
         return ptr_ ? ptr_->RefCount() : 0;
     };
-    explicit operator bool() const {
+    constexpr explicit operator bool() const {
         return ptr_ != nullptr;
     };
+
+    // Owner-based ordering and hashing. The counter lives in the object, so the owner is the
+    // object itself, identified by its `RefCounted` base: with multiple inheritance, pointers to
+    // the object through different bases hold different addresses.
+    template <typename Y>
+    bool OwnerBefore(const IntrusivePtr<Y>& other) const noexcept {
+        return std::less<const void*>()(OwnerAddress(ptr_), OwnerAddress(other.ptr_));
+    }
+    template <typename Y>
+    bool OwnerEqual(const IntrusivePtr<Y>& other) const noexcept {
+        return OwnerAddress(ptr_) == OwnerAddress(other.ptr_);
+    }
+    size_t OwnerHash() const noexcept {
+        return std::hash<const void*>()(OwnerAddress(ptr_));
+    }
+
+private:
+    template <typename Derived, typename Counter, typename Deleter>
+    static const void* OwnerAddress(const RefCounted<Derived, Counter, Deleter>* object) noexcept {
+        return object;
+    }
+};
+
+template <typename T, typename Y>
+constexpr bool operator==(const IntrusivePtr<T>& left, const IntrusivePtr<Y>& right) {
+    return left.Get() == right.Get();
+}
+
+template <typename T>
+struct std::hash<IntrusivePtr<T>> {
+    size_t operator()(const IntrusivePtr<T>& ptr) const noexcept {
+        return std::hash<T*>()(ptr.Get());
+    }
 };
 
 template <typename T, typename... Args>
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <atomic>   // for std::atomic
+#include <cstddef>  // for std::nullptr_t
+#include <thread>   // for std::this_thread::yield
+#include <utility>  // for std::swap
+
+// Weak references to `RefCounted` objects.
+//
+// An object which supports weak references keeps one extra pointer: a slot for a side table,
+// allocated the first time a weak reference is taken. The side table points back to the object
+// and counts weak references; it outlives the object as long as any `IntrusiveWeakPtr` does.
+//
+// Destruction is ordered as follows: the last `DecRef` detaches the object from the side
+// table, then `Deleter::Destroy` runs, then the object drops its own reference to the table.
+// `Lock` takes a reference with a lock-free `IncRefIfNotZero`, so it either wins before the
+// counter hits zero or sees the object gone. Readers of the object announce themselves in the
+// table, and `Detach` waits for those which may have seen the object before it was cleared, so
+// the counter is never touched after the object is freed.
+
+template <typename Derived>
+class WeakRefSideTable {
+public:
+    explicit WeakRefSideTable(Derived* object) : object_(object) {
+    }
+
+    WeakRefSideTable(const WeakRefSideTable&) = delete;
+    WeakRefSideTable& operator=(const WeakRefSideTable&) = delete;
+
+    void IncWeak() {
+        weak_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void DecWeak() {
+        if (weak_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    // Returns the object with a new strong reference, or nullptr if it is dead or dying.
+    Derived* TryLock() {
+        Derived* object = BeginRead();
+        if (object && !object->IncRefIfNotZero()) {
+            object = nullptr;
+        }
+        EndRead();
+        return object;
+    }
+
+    size_t UseCount() {
+        Derived* object = BeginRead();
+        size_t count = object ? object->RefCount() : 0;
+        EndRead();
+        return count;
+    }
+
+    // Called once the count is zero: no reader which still sees the object outlives this call.
+    void Detach() {
+        object_.store(nullptr, std::memory_order_seq_cst);
+        while (readers_.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    // Sequentially consistent on both sides: either `Detach` sees the reader, or the reader sees
+    // the cleared object.
+    Derived* BeginRead() {
+        readers_.fetch_add(1, std::memory_order_seq_cst);
+        return object_.load(std::memory_order_seq_cst);
+    }
+
+    void EndRead() {
+        readers_.fetch_sub(1, std::memory_order_release);
+    }
+
+    std::atomic<Derived*> object_;
+    std::atomic<size_t> readers_ = 0;
+    // Weak references plus one held by the object until it is destroyed.
+    std::atomic<size_t> weak_count_ = 1;
+};
+
+template <typename Derived, typename Counter = SimpleCounter, typename Deleter = DefaultDelete>
+class WeakRefCounted : public RefCounted<Derived, Counter, Deleter> {
+public:
+    using SideTable = WeakRefSideTable<Derived>;
+
+    WeakRefCounted() = default;
+
+    // A copy is a new object: nobody holds weak references to it yet.
+    WeakRefCounted(const WeakRefCounted& other) : RefCounted<Derived, Counter, Deleter>(other) {
+    }
+
+    WeakRefCounted& operator=(const WeakRefCounted&) {
+        return *this;
+    }
+
+    // Decrease reference counter.
+    // Detach weak references and destroy object using Deleter when the last instance dies.
+    void DecRef() {
+        if (this->counter_.DecRef() == 0) {
+            SideTable* side_table = side_table_.load(std::memory_order_acquire);
+            if (side_table) {
+                side_table->Detach();
+            }
+            Deleter::Destroy(static_cast<Derived*>(this));
+            if (side_table) {
+                side_table->DecWeak();
+            }
+        }
+    };
+
+    // Take a reference only if the object is still alive.
+    bool IncRefIfNotZero() {
+        return this->counter_.IncRefIfNotZero();
+    }
+
+    // The side table of the object, allocated on the first call.
+    // The caller must hold a strong reference.
+    SideTable* GetWeakSideTable() {
+        SideTable* side_table = side_table_.load(std::memory_order_acquire);
+        if (side_table) {
+            return side_table;
+        }
+        auto* created = new SideTable(static_cast<Derived*>(this));
+        if (side_table_.compare_exchange_strong(side_table, created, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+            return created;
+        }
+        delete created;
+        return side_table;
+    }
+
+private:
+    std::atomic<SideTable*> side_table_ = nullptr;
+};
+
+template <typename Derived, typename D = DefaultDelete>
+using SimpleWeakRefCounted = WeakRefCounted<Derived, SimpleCounter, D>;
+
+template <typename Derived, typename D = DefaultDelete>
+using ThreadSafeWeakRefCounted = WeakRefCounted<Derived, ThreadSafeCounter, D>;
+
+// `T` must derive from some `WeakRefCounted<Derived, ...>`; the pointer is a single word.
+template <typename T>
+class IntrusiveWeakPtr {
+    using SideTable = typename T::SideTable;
+
+    SideTable* side_table_;
+
+    template <typename Y>
+    friend class IntrusiveWeakPtr;
+
+public:
+    // Constructors
+    IntrusiveWeakPtr() : side_table_(nullptr){};
+    IntrusiveWeakPtr(std::nullptr_t) : side_table_(nullptr){};
+
+    template <typename Y>
+    IntrusiveWeakPtr(const IntrusivePtr<Y>& other)
+        : side_table_(other ? static_cast<T*>(other.Get())->GetWeakSideTable() : nullptr) {
+        if (side_table_) {
+            side_table_->IncWeak();
+        }
+    };
+
+    template <typename Y>
+    IntrusiveWeakPtr(const IntrusiveWeakPtr<Y>& other) : side_table_(other.side_table_) {
+        if (side_table_) {
+            side_table_->IncWeak();
+        }
+    };
+
+    template <typename Y>
+    IntrusiveWeakPtr(IntrusiveWeakPtr<Y>&& other) : side_table_(other.side_table_) {
+        other.side_table_ = nullptr;
+    };
+
+    IntrusiveWeakPtr(const IntrusiveWeakPtr& other) : side_table_(other.side_table_) {
+        if (side_table_) {
+            side_table_->IncWeak();
+        }
+    };
+    IntrusiveWeakPtr(IntrusiveWeakPtr&& other) : side_table_(other.side_table_) {
+        other.side_table_ = nullptr;
+    };
+
+    // `operator=`-s
+    IntrusiveWeakPtr& operator=(const IntrusiveWeakPtr& other) {
+        if (side_table_ != other.side_table_) {
+            IntrusiveWeakPtr{other}.Swap(*this);
+        }
+        return *this;
+    };
+    IntrusiveWeakPtr& operator=(IntrusiveWeakPtr&& other) {
+        if (side_table_ != other.side_table_) {
+            IntrusiveWeakPtr{std::move(other)}.Swap(*this);
+        }
+        return *this;
+    };
+
+    // Destructor
+    ~IntrusiveWeakPtr() {
+        if (side_table_) {
+            side_table_->DecWeak();
+        }
+    };
+
+    // Modifiers
+    void Reset() {
+        if (side_table_) {
+            side_table_->DecWeak();
+            side_table_ = nullptr;
+        }
+    };
+
+    void Swap(IntrusiveWeakPtr& other) {
+        std::swap(side_table_, other.side_table_);
+    };
+
+    // Observers
+    size_t UseCount() const {
+        return side_table_ ? side_table_->UseCount() : 0;
+    };
+
+    bool Expired() const {
+        return UseCount() == 0;
+    };
+
+    IntrusivePtr<T> Lock() const {
+        IntrusivePtr<T> result;
+        if (side_table_) {
+            // The side table belongs to the object this pointer was created from, which is a `T`.
+            result.ptr_ = static_cast<T*>(side_table_->TryLock());
+        }
+        return result;
+    };
+};
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "intrusive.h"
+#include "object_pool.h"
+
+#include <atomic>   // for std::atomic
+#include <bit>      // for std::bit_width
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint32_t / uint64_t
+#include <mutex>    // for std::mutex / std::lock_guard
+#include <utility>  // for std::forward / std::swap
+#include <vector>   // for std::vector
+
+template <typename T>
+class MagazinePool;
+
+template <typename Derived>
+using ObjectInMagazinePool = ObjectInPool<Derived, ThreadSafeCounter, MagazinePool<Derived>>;
+
+// Object pool for objects allocated on one thread and released on another.
+//
+// Every thread keeps two magazines (fixed-size stacks of idle objects) for each pool it uses, so
+// the common case touches no shared state. When both are empty, an allocation swaps an empty
+// magazine for a full one from the depot; when both are full, a release hands a full one to the
+// depot. The depot is a pair of lock-free stacks of magazines, so a thread which only releases
+// returns its objects in batches of `kRounds`.
+//
+// At most `max_magazines` magazines are created; beyond that a released object is deleted.
+// A thread's magazines go back to the depot when it exits. The pool must outlive every object
+// it handed out, and no thread may use it while it is destroyed.
+template <typename T>
+class MagazinePool {
+    static_assert(std::is_base_of_v<ObjectPoolHook<T, MagazinePool>, T>, "Unsupported type");
+
+public:
+    static constexpr size_t kRounds = 32;
+
+    explicit MagazinePool(uint32_t max_magazines = 1024)
+        : max_magazines_(max_magazines), registration_(new Registration(this)) {
+    }
+
+    MagazinePool(const MagazinePool&) = delete;
+    MagazinePool& operator=(const MagazinePool&) = delete;
+
+    ~MagazinePool() {
+        {
+            std::lock_guard lock(registration_->mutex);
+            registration_->pool = nullptr;
+        }
+        uint32_t count = num_magazines_.load(std::memory_order_relaxed);
+        for (uint32_t index = 0; index < count; ++index) {
+            Magazine& magazine = At(index);
+            for (size_t i = 0; i < magazine.size; ++i) {
+                delete magazine.rounds[i];
+            }
+        }
+        for (std::atomic<Magazine*>& chunk : chunks_) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    template <typename... Args>
+    IntrusivePtr<T> Allocate(Args&&... args) {
+        if (T* object = Pop(LocalCache())) {
+            return IntrusivePtr<T>(object);
+        }
+        created_.fetch_add(1, std::memory_order_relaxed);
+        T* object = new T(std::forward<Args>(args)...);
+        object->home_ = this;
+        return IntrusivePtr<T>(object);
+    }
+
+    // Called by `ReturnToPool` when the last reference to `object` dies.
+    void Release(T* object) {
+        if (!Push(LocalCache(), object)) {
+            delete object;
+        }
+    }
+
+    // The number of objects constructed by the pool.
+    size_t NumCreated() const {
+        return created_.load(std::memory_order_relaxed);
+    }
+
+    size_t NumMagazines() const {
+        return num_magazines_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint32_t kNoMagazine = UINT32_MAX;
+    static constexpr size_t kMaxChunks = 32;
+
+    struct Magazine {
+        T* rounds[kRounds];
+        size_t size = 0;
+        // Index of the next magazine in a depot stack, plus one.
+        std::atomic<uint32_t> next = 0;
+    };
+
+    // Magazines are never freed before the pool, so a stack links them by index and keeps an
+    // ABA tag next to the head, both in one 64-bit word.
+    class MagazineStack {
+    public:
+        void Push(MagazinePool* pool, uint32_t index) {
+            uint64_t head = head_.load(std::memory_order_relaxed);
+            do {
+                pool->At(index).next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            } while (!head_.compare_exchange_weak(head, Pack(head, index + 1),
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+        }
+
+        uint32_t Pop(MagazinePool* pool) {
+            uint64_t head = head_.load(std::memory_order_acquire);
+            while (static_cast<uint32_t>(head) != 0) {
+                uint32_t index = static_cast<uint32_t>(head) - 1;
+                uint32_t next = pool->At(index).next.load(std::memory_order_relaxed);
+                if (head_.compare_exchange_weak(head, Pack(head, next), std::memory_order_acquire,
+                                                std::memory_order_acquire)) {
+                    return index;
+                }
+            }
+            return kNoMagazine;
+        }
+
+    private:
+        static uint64_t Pack(uint64_t old_head, uint32_t link) {
+            return ((old_head >> 32) + 1) << 32 | link;
+        }
+
+        std::atomic<uint64_t> head_ = 0;
+    };
+
+    struct ThreadCache {
+        uint32_t loaded = kNoMagazine;
+        uint32_t previous = kNoMagazine;
+    };
+
+    // Lets a thread hand its magazines back on exit if the pool is still alive.
+    struct Registration : ThreadSafeRefCounted<Registration> {
+        explicit Registration(MagazinePool* pool) : pool(pool) {
+        }
+
+        std::mutex mutex;
+        MagazinePool* pool;
+    };
+
+    struct LocalEntry {
+        LocalEntry(IntrusivePtr<Registration> registration)
+            : registration(std::move(registration)) {
+        }
+        LocalEntry(LocalEntry&&) = default;
+        LocalEntry& operator=(LocalEntry&&) = default;
+
+        ~LocalEntry() {
+            if (registration) {
+                std::lock_guard lock(registration->mutex);
+                if (registration->pool) {
+                    registration->pool->Flush(cache);
+                }
+            }
+        }
+
+        IntrusivePtr<Registration> registration;
+        ThreadCache cache;
+    };
+
+    static std::vector<LocalEntry>& LocalEntries() {
+        thread_local std::vector<LocalEntry> entries;
+        return entries;
+    }
+
+    ThreadCache& LocalCache() {
+        std::vector<LocalEntry>& entries = LocalEntries();
+        for (LocalEntry& entry : entries) {
+            if (entry.registration.Get() == registration_.Get()) {
+                return entry.cache;
+            }
+        }
+        // Forget the pools destroyed since this thread used them.
+        std::erase_if(entries, [](const LocalEntry& entry) {
+            std::lock_guard lock(entry.registration->mutex);
+            return entry.registration->pool == nullptr;
+        });
+        return entries.emplace_back(registration_).cache;
+    }
+
+    T* Pop(ThreadCache& cache) {
+        if (cache.loaded != kNoMagazine && At(cache.loaded).size != 0) {
+            return TakeRound(At(cache.loaded));
+        }
+        if (cache.previous != kNoMagazine && At(cache.previous).size != 0) {
+            std::swap(cache.loaded, cache.previous);
+            return TakeRound(At(cache.loaded));
+        }
+        uint32_t full = full_.Pop(this);
+        if (full == kNoMagazine) {
+            return nullptr;
+        }
+        if (cache.previous != kNoMagazine) {
+            empty_.Push(this, cache.previous);
+        }
+        cache.previous = cache.loaded;
+        cache.loaded = full;
+        return TakeRound(At(cache.loaded));
+    }
+
+    bool Push(ThreadCache& cache, T* object) {
+        if (cache.loaded != kNoMagazine && At(cache.loaded).size != kRounds) {
+            PutRound(At(cache.loaded), object);
+            return true;
+        }
+        if (cache.previous != kNoMagazine && At(cache.previous).size != kRounds) {
+            std::swap(cache.loaded, cache.previous);
+            PutRound(At(cache.loaded), object);
+            return true;
+        }
+        uint32_t empty = empty_.Pop(this);
+        if (empty == kNoMagazine) {
+            empty = NewMagazine();
+            if (empty == kNoMagazine) {
+                return false;
+            }
+        }
+        if (cache.previous != kNoMagazine) {
+            full_.Push(this, cache.previous);
+        }
+        cache.previous = cache.loaded;
+        cache.loaded = empty;
+        PutRound(At(cache.loaded), object);
+        return true;
+    }
+
+    void Flush(ThreadCache& cache) {
+        for (uint32_t index : {cache.loaded, cache.previous}) {
+            if (index != kNoMagazine) {
+                (At(index).size != 0 ? full_ : empty_).Push(this, index);
+            }
+        }
+        cache = ThreadCache{};
+    }
+
+    static T* TakeRound(Magazine& magazine) {
+        return magazine.rounds[--magazine.size];
+    }
+
+    static void PutRound(Magazine& magazine, T* object) {
+        magazine.rounds[magazine.size++] = object;
+    }
+
+    // Magazine `index` lives in chunk `bit_width(index + 1) - 1`, chunk `c` holding `2^c` of
+    // them, so the addresses stay stable while new chunks are added.
+    Magazine& At(uint32_t index) {
+        uint64_t position = uint64_t{index} + 1;
+        size_t chunk = std::bit_width(position) - 1;
+        return chunks_[chunk].load(std::memory_order_acquire)[position - (uint64_t{1} << chunk)];
+    }
+
+    uint32_t NewMagazine() {
+        uint32_t index = num_magazines_.load(std::memory_order_relaxed);
+        do {
+            if (index >= max_magazines_) {
+                return kNoMagazine;
+            }
+        } while (!num_magazines_.compare_exchange_weak(index, index + 1,
+                                                       std::memory_order_relaxed));
+        uint64_t position = uint64_t{index} + 1;
+        size_t chunk = std::bit_width(position) - 1;
+        if (!chunks_[chunk].load(std::memory_order_acquire)) {
+            std::lock_guard lock(chunks_mutex_);
+            if (!chunks_[chunk].load(std::memory_order_relaxed)) {
+                chunks_[chunk].store(new Magazine[size_t{1} << chunk], std::memory_order_release);
+            }
+        }
+        return index;
+    }
+
+    const uint32_t max_magazines_;
+    IntrusivePtr<Registration> registration_;
+    MagazineStack full_;
+    MagazineStack empty_;
+    std::atomic<Magazine*> chunks_[kMaxChunks] = {};
+    std::mutex chunks_mutex_;
+    std::atomic<uint32_t> num_magazines_ = 0;
+    std::atomic<size_t> created_ = 0;
+};
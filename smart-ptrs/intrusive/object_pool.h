@@ -0,0 +1,171 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <cstddef>      // for size_t
+#include <limits>       // for std::numeric_limits
+#include <type_traits>  // for std::is_base_of_v
+#include <utility>      // for std::forward
+
+template <typename T>
+class ObjectPool;
+
+// Per-object bookkeeping of a pool: the home pool and the link of the free list.
+// Idle objects are chained through `next_free_`, so returning one never allocates.
+template <typename Derived, typename Pool = ObjectPool<Derived>>
+class ObjectPoolHook {
+public:
+    ObjectPoolHook() = default;
+
+    // A copy is not registered in any pool.
+    ObjectPoolHook(const ObjectPoolHook&) {
+    }
+
+    ObjectPoolHook& operator=(const ObjectPoolHook&) {
+        return *this;
+    }
+
+    Pool* GetHome() const {
+        return home_;
+    }
+
+private:
+    Pool* home_ = nullptr;
+    Derived* next_free_ = nullptr;
+
+    friend Pool;
+};
+
+// `RefCounted` deleter which hands the object back to its pool instead of deleting it.
+struct ReturnToPool {
+    template <typename T>
+    static void Destroy(T* object) {
+        object->GetHome()->Release(object);
+    }
+};
+
+// Mixin for pooled objects: `DecRef` of the last reference returns the object to its pool.
+template <typename Derived, typename Counter = SimpleCounter, typename Pool = ObjectPool<Derived>>
+class ObjectInPool : public RefCounted<Derived, Counter, ReturnToPool>,
+                     public ObjectPoolHook<Derived, Pool> {};
+
+// Recycles `IntrusivePtr`-owned objects.
+//
+// `Allocate` hands out an idle object if there is one (its constructor arguments are ignored),
+// otherwise constructs a new one. When the last reference dies, the object runs the reset
+// hook and goes back to the pool, or is deleted if `Capacity()` idle objects are kept already.
+// The pool must outlive every object it handed out. Not thread-safe.
+template <typename T>
+class ObjectPool {
+    static_assert(std::is_base_of_v<ObjectPoolHook<T>, T>, "Unsupported type");
+
+public:
+    using ResetHook = void (*)(T&);
+
+    static constexpr size_t kUnbounded = std::numeric_limits<size_t>::max();
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t in_use = 0;
+        size_t available = 0;
+        size_t high_water_mark = 0;
+    };
+
+    // `capacity` bounds the number of idle objects kept for reuse.
+    explicit ObjectPool(size_t capacity = kUnbounded, ResetHook reset = nullptr)
+        : capacity_(capacity), reset_(reset) {
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    ~ObjectPool() {
+        Trim(0);
+    }
+
+    template <typename... Args>
+    IntrusivePtr<T> Allocate(Args&&... args) {
+        T* object = free_list_;
+        if (object) {
+            free_list_ = object->next_free_;
+            object->next_free_ = nullptr;
+            --stats_.available;
+            ++stats_.hits;
+        } else {
+            object = Create(std::forward<Args>(args)...);
+            ++stats_.misses;
+        }
+        ++stats_.in_use;
+        if (stats_.in_use > stats_.high_water_mark) {
+            stats_.high_water_mark = stats_.in_use;
+        }
+        return IntrusivePtr<T>(object);
+    }
+
+    // Constructs idle objects until `count` of them are available.
+    template <typename... Args>
+    void Reserve(size_t count, const Args&... args) {
+        while (stats_.available < count && stats_.available < capacity_) {
+            Push(Create(args...));
+        }
+    }
+
+    // Deletes idle objects until at most `keep` of them are left, e.g. under memory pressure.
+    void Trim(size_t keep = 0) {
+        while (stats_.available > keep) {
+            T* object = free_list_;
+            free_list_ = object->next_free_;
+            --stats_.available;
+            delete object;
+        }
+    }
+
+    // Called by `ReturnToPool` when the last reference to `object` dies.
+    void Release(T* object) {
+        --stats_.in_use;
+        if (stats_.available >= capacity_) {
+            delete object;
+            return;
+        }
+        if (reset_) {
+            reset_(*object);
+        }
+        Push(object);
+    }
+
+    size_t NumAvailable() const {
+        return stats_.available;
+    }
+
+    size_t NumInUse() const {
+        return stats_.in_use;
+    }
+
+    size_t Capacity() const {
+        return capacity_;
+    }
+
+    const Stats& GetStats() const {
+        return stats_;
+    }
+
+private:
+    template <typename... Args>
+    T* Create(Args&&... args) {
+        T* object = new T(std::forward<Args>(args)...);
+        object->home_ = this;
+        return object;
+    }
+
+    void Push(T* object) {
+        object->next_free_ = free_list_;
+        free_list_ = object;
+        ++stats_.available;
+    }
+
+    size_t capacity_;
+    ResetHook reset_;
+    T* free_list_ = nullptr;
+    Stats stats_;
+};
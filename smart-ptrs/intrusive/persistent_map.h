@@ -0,0 +1,248 @@
+#pragma once
+
+#include "persistent_node.h"
+
+#include <bit>         // for std::popcount
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t
+#include <functional>  // for std::hash
+#include <utility>     // for std::move / std::swap
+#include <vector>      // for std::vector
+
+// Immutable hash map with structural sharing: a hash array mapped trie (HAMT) which consumes the
+// hash 5 bits per level. A node keeps its entries and its children in two dense arrays, indexed
+// by the popcount of two 32-bit masks (the compressed layout of CHAMP), so a lookup touches one
+// node per level and an update copies only the nodes on its path.
+//
+// Keys whose hashes are equal in all bits share a collision node, searched linearly. Removal
+// folds a child left with a single entry back into its parent, so the shape depends only on the
+// keys, never on the history of updates.
+//
+// Updates return the new version and are transient on rvalues, as in `PersistentVector`.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class PersistentHashMap {
+    static constexpr unsigned kBits = 5;
+    static constexpr unsigned kHashBits = 8 * sizeof(size_t);
+
+    struct Entry {
+        size_t hash;
+        K key;
+        V value;
+    };
+
+    struct Node : ThreadSafeRefCounted<Node> {
+        // Which 5-bit hash fragments have an entry, and which a child.
+        uint32_t datamap = 0;
+        uint32_t nodemap = 0;
+        // In fragment order; below the last level, all the colliding entries in any order.
+        std::vector<Entry> entries;
+        std::vector<IntrusivePtr<Node>> children;
+    };
+
+public:
+    PersistentHashMap() = default;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    size_t Size() const {
+        return size_;
+    }
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    // The value of `key`, or null.
+    const V* Find(const K& key) const {
+        size_t hash = Hash()(key);
+        const Node* node = root_.Get();
+        for (unsigned shift = 0; node; shift += kBits) {
+            if (shift >= kHashBits) {
+                for (const Entry& entry : node->entries) {
+                    if (entry.key == key) {
+                        return &entry.value;
+                    }
+                }
+                return nullptr;
+            }
+            uint32_t bit = Bit(hash, shift);
+            if (node->datamap & bit) {
+                const Entry& entry = node->entries[Index(node->datamap, bit)];
+                return entry.hash == hash && entry.key == key ? &entry.value : nullptr;
+            }
+            if (!(node->nodemap & bit)) {
+                return nullptr;
+            }
+            node = node->children[Index(node->nodemap, bit)].Get();
+        }
+        return nullptr;
+    }
+
+    bool Contains(const K& key) const {
+        return Find(key) != nullptr;
+    }
+
+    // Calls `fn(key, value)` for every entry, in no particular order.
+    template <typename F>
+    void ForEach(F&& fn) const {
+        if (root_) {
+            ForEach(*root_, fn);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Updates
+
+    // Inserts `key` or assigns to its value.
+    PersistentHashMap Set(K key, V value) const& {
+        return PersistentHashMap(*this).Set(std::move(key), std::move(value));
+    }
+
+    PersistentHashMap Set(K key, V value) && {
+        size_t hash = Hash()(key);
+        if (Insert(root_, 0, Entry{hash, std::move(key), std::move(value)})) {
+            ++size_;
+        }
+        return std::move(*this);
+    }
+
+    // Removes `key` if present; otherwise the result shares the whole trie.
+    PersistentHashMap Erase(const K& key) const& {
+        if (!Contains(key)) {
+            return *this;
+        }
+        return PersistentHashMap(*this).Erase(key);
+    }
+
+    PersistentHashMap Erase(const K& key) && {
+        if (Contains(key)) {
+            Remove(root_, 0, Hash()(key), key);
+            if (--size_ == 0) {
+                root_.Reset();
+            }
+        }
+        return std::move(*this);
+    }
+
+private:
+    static uint32_t Bit(size_t hash, unsigned shift) {
+        return uint32_t(1) << ((hash >> shift) & 31);
+    }
+
+    // The position of `bit`'s element among those present in `map`.
+    static size_t Index(uint32_t map, uint32_t bit) {
+        return std::popcount(map & (bit - 1));
+    }
+
+    template <typename F>
+    static void ForEach(const Node& node, F& fn) {
+        for (const Entry& entry : node.entries) {
+            fn(entry.key, entry.value);
+        }
+        for (const IntrusivePtr<Node>& child : node.children) {
+            ForEach(*child, fn);
+        }
+    }
+
+    // Returns whether the key is new.
+    static bool Insert(IntrusivePtr<Node>& slot, unsigned shift, Entry entry) {
+        Node* node = persistent_detail::MakeWritable<Node>(slot);
+        if (shift >= kHashBits) {
+            for (Entry& existing : node->entries) {
+                if (existing.key == entry.key) {
+                    existing.value = std::move(entry.value);
+                    return false;
+                }
+            }
+            node->entries.push_back(std::move(entry));
+            return true;
+        }
+
+        uint32_t bit = Bit(entry.hash, shift);
+        if (node->nodemap & bit) {
+            return Insert(node->children[Index(node->nodemap, bit)], shift + kBits,
+                          std::move(entry));
+        }
+        size_t index = Index(node->datamap, bit);
+        if (!(node->datamap & bit)) {
+            node->entries.insert(node->entries.begin() + index, std::move(entry));
+            node->datamap |= bit;
+            return true;
+        }
+        Entry& existing = node->entries[index];
+        if (existing.hash == entry.hash && existing.key == entry.key) {
+            existing.value = std::move(entry.value);
+            return false;
+        }
+
+        // Two keys for one fragment: both move down into a new child.
+        IntrusivePtr<Node> child = Merge(shift + kBits, std::move(existing), std::move(entry));
+        node->entries.erase(node->entries.begin() + index);
+        node->datamap &= ~bit;
+        node->children.insert(node->children.begin() + Index(node->nodemap, bit),
+                              std::move(child));
+        node->nodemap |= bit;
+        return true;
+    }
+
+    // The subtrie at `shift` holding exactly these two entries.
+    static IntrusivePtr<Node> Merge(unsigned shift, Entry first, Entry second) {
+        auto node = MakeIntrusive<Node>();
+        if (shift >= kHashBits) {
+            node->entries.push_back(std::move(first));
+            node->entries.push_back(std::move(second));
+            return node;
+        }
+        uint32_t first_bit = Bit(first.hash, shift);
+        uint32_t second_bit = Bit(second.hash, shift);
+        if (first_bit == second_bit) {
+            node->children.push_back(Merge(shift + kBits, std::move(first), std::move(second)));
+            node->nodemap = first_bit;
+        } else {
+            if (first_bit > second_bit) {
+                std::swap(first, second);
+            }
+            node->entries.push_back(std::move(first));
+            node->entries.push_back(std::move(second));
+            node->datamap = first_bit | second_bit;
+        }
+        return node;
+    }
+
+    // `key` must be present.
+    static void Remove(IntrusivePtr<Node>& slot, unsigned shift, size_t hash, const K& key) {
+        Node* node = persistent_detail::MakeWritable<Node>(slot);
+        if (shift >= kHashBits) {
+            for (auto it = node->entries.begin(); it != node->entries.end(); ++it) {
+                if (it->key == key) {
+                    node->entries.erase(it);
+                    return;
+                }
+            }
+            return;
+        }
+
+        uint32_t bit = Bit(hash, shift);
+        if (node->datamap & bit) {
+            node->entries.erase(node->entries.begin() + Index(node->datamap, bit));
+            node->datamap &= ~bit;
+            return;
+        }
+        size_t index = Index(node->nodemap, bit);
+        Remove(node->children[index], shift + kBits, hash, key);
+
+        // A child left with a single entry is folded back into this node.
+        Node& child = *node->children[index];
+        if (child.children.empty() && child.entries.size() == 1) {
+            Entry entry = std::move(child.entries.front());
+            node->children.erase(node->children.begin() + index);
+            node->nodemap &= ~bit;
+            node->entries.insert(node->entries.begin() + Index(node->datamap, bit),
+                                 std::move(entry));
+            node->datamap |= bit;
+        }
+    }
+
+    IntrusivePtr<Node> root_;
+    size_t size_ = 0;
+};
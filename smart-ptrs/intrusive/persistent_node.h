@@ -0,0 +1,42 @@
+#pragma once
+
+#include "intrusive.h"
+
+#include <atomic>  // for std::atomic_thread_fence
+
+// Building blocks of the persistent containers: immutable `RefCounted` nodes linked by
+// `IntrusivePtr`, where an update copies the path from the root to the changed node and shares
+// everything else with the previous version.
+//
+// A node which only one pointer references can be changed in place instead (transient update):
+// no version other than the one being updated can reach it, as long as the whole path to it is
+// referenced only once too. Walking down from a root the updater owns, with every node on the
+// way made writable first, keeps that invariant: copying a shared node takes a reference to each
+// of its children, so they show up as shared in turn.
+namespace persistent_detail {
+
+// Whether `node` may be modified in place. Counts are read relaxed: the acquire fence pairs with
+// the release decrement of the last other owner, so its reads of the node happen before the
+// caller's writes.
+template <typename Node>
+bool IsExclusive(const Node& node) {
+    if (node.RefCount() != 1) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+
+// Makes `slot` the only reference to its node: a copy of the node (sharing its children) if it
+// is shared, a new empty `Kind` if there is none. Returns the node as the `Kind` it is.
+template <typename Kind, typename Node>
+Kind* MakeWritable(IntrusivePtr<Node>& slot) {
+    if (!slot) {
+        slot = MakeIntrusive<Kind>();
+    } else if (!IsExclusive(*slot)) {
+        slot = MakeIntrusive<Kind>(static_cast<const Kind&>(*slot));
+    }
+    return static_cast<Kind*>(slot.Get());
+}
+
+}  // namespace persistent_detail
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "persistent_node.h"
+
+#include <algorithm>    // for std::min
+#include <cstddef>      // for size_t
+#include <stdexcept>    // for std::out_of_range
+#include <type_traits>  // for std::is_default_constructible_v / std::is_copy_constructible_v
+#include <utility>      // for std::move
+
+// Immutable vector with structural sharing: a radix-balanced trie of 32-wide nodes plus a tail
+// leaf for the last (up to) 32 elements, so `PushBack` mostly touches the tail only. Indexing
+// walks `log32(n)` levels; an update copies them and shares everything else with the previous
+// version, so keeping many versions costs little more than keeping one.
+//
+// Every update returns the new version. Called on an rvalue (`std::move(v).PushBack(x)`), it is
+// transient: nodes this version alone references are changed in place, without allocating.
+// Versions may be shared between threads; a single `PersistentVector` is not synchronized.
+template <typename T>
+class PersistentVector {
+    static_assert(std::is_default_constructible_v<T> && std::is_copy_constructible_v<T>,
+                  "Leaves hold default-constructed elements and are copied on update");
+
+    static constexpr unsigned kBits = 5;
+    static constexpr size_t kWidth = size_t(1) << kBits;
+    static constexpr size_t kMask = kWidth - 1;
+
+    struct Node;
+
+    // Nodes are deleted as what they are without a virtual destructor.
+    struct NodeDelete {
+        static void Destroy(Node* node) {
+            if (node->is_leaf) {
+                delete static_cast<Leaf*>(node);
+            } else {
+                delete static_cast<Branch*>(node);
+            }
+        }
+    };
+
+    struct Node : ThreadSafeRefCounted<Node, NodeDelete> {
+        explicit Node(bool is_leaf) : is_leaf(is_leaf) {
+        }
+
+        bool is_leaf;
+    };
+
+    struct Leaf : Node {
+        Leaf() : Node(true) {
+        }
+
+        T values[kWidth] = {};
+    };
+
+    struct Branch : Node {
+        Branch() : Node(false) {
+        }
+
+        IntrusivePtr<Node> children[kWidth];
+    };
+
+public:
+    PersistentVector() = default;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    size_t Size() const {
+        return size_;
+    }
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    const T& operator[](size_t index) const {
+        return LeafFor(index)->values[index & kMask];
+    }
+
+    const T& At(size_t index) const {
+        CheckIndex(index);
+        return (*this)[index];
+    }
+
+    const T& Back() const {
+        return (*this)[size_ - 1];
+    }
+
+    // Calls `fn` with every element in order, one leaf lookup per 32 elements.
+    template <typename F>
+    void ForEach(F&& fn) const {
+        for (size_t base = 0; base < size_; base += kWidth) {
+            const Leaf* leaf = LeafFor(base);
+            size_t count = std::min(kWidth, size_ - base);
+            for (size_t i = 0; i < count; ++i) {
+                fn(leaf->values[i]);
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Updates
+
+    PersistentVector Set(size_t index, T value) const& {
+        return PersistentVector(*this).Set(index, std::move(value));
+    }
+
+    PersistentVector Set(size_t index, T value) && {
+        CheckIndex(index);
+        IntrusivePtr<Node>* slot = &tail_;
+        if (index < TailOffset()) {
+            slot = &root_;
+            for (unsigned level = shift_; level > 0; level -= kBits) {
+                slot = &MakeWritable<Branch>(*slot)->children[(index >> level) & kMask];
+            }
+        }
+        MakeWritable<Leaf>(*slot)->values[index & kMask] = std::move(value);
+        return std::move(*this);
+    }
+
+    PersistentVector PushBack(T value) const& {
+        return PersistentVector(*this).PushBack(std::move(value));
+    }
+
+    PersistentVector PushBack(T value) && {
+        size_t in_tail = size_ - TailOffset();
+        if (in_tail == kWidth) {
+            // The tail is full: it becomes the last leaf of the trie, which grows a level when
+            // the root is full too.
+            if ((size_ >> kBits) > (size_t(1) << shift_)) {
+                auto root = MakeIntrusive<Branch>();
+                root->children[0] = std::move(root_);
+                root->children[1] = NewPath(shift_, std::move(tail_));
+                root_ = std::move(root);
+                shift_ += kBits;
+            } else {
+                PushTail(shift_, root_, std::move(tail_));
+            }
+            in_tail = 0;
+        }
+        MakeWritable<Leaf>(tail_)->values[in_tail] = std::move(value);
+        ++size_;
+        return std::move(*this);
+    }
+
+    PersistentVector PopBack() const& {
+        return PersistentVector(*this).PopBack();
+    }
+
+    PersistentVector PopBack() && {
+        if (size_ == 0) {
+            throw std::out_of_range("PersistentVector: PopBack of an empty vector");
+        }
+        size_t in_tail = size_ - TailOffset();
+        if (size_ == 1) {
+            tail_.Reset();
+        } else if (in_tail > 1) {
+            // Releases whatever the element holds.
+            MakeWritable<Leaf>(tail_)->values[in_tail - 1] = T();
+        } else {
+            // The tail is emptied: the last leaf of the trie takes its place.
+            tail_ = IntrusivePtr<Node>(const_cast<Leaf*>(LeafFor(size_ - 2)));
+            PopTail(shift_, root_);
+            if (shift_ > kBits && !AsBranch(root_)->children[1]) {
+                IntrusivePtr<Node> only_child = AsBranch(root_)->children[0];
+                root_ = std::move(only_child);
+                shift_ -= kBits;
+            }
+        }
+        --size_;
+        return std::move(*this);
+    }
+
+private:
+    template <typename Kind>
+    static Kind* MakeWritable(IntrusivePtr<Node>& slot) {
+        return persistent_detail::MakeWritable<Kind>(slot);
+    }
+
+    static const Branch* AsBranch(const IntrusivePtr<Node>& node) {
+        return static_cast<const Branch*>(node.Get());
+    }
+
+    void CheckIndex(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("PersistentVector: index out of range");
+        }
+    }
+
+    // The index of the first element in the tail.
+    size_t TailOffset() const {
+        return size_ < kWidth ? 0 : ((size_ - 1) >> kBits) << kBits;
+    }
+
+    const Leaf* LeafFor(size_t index) const {
+        if (index >= TailOffset()) {
+            return static_cast<const Leaf*>(tail_.Get());
+        }
+        const Node* node = root_.Get();
+        for (unsigned level = shift_; level > 0; level -= kBits) {
+            node = static_cast<const Branch*>(node)->children[(index >> level) & kMask].Get();
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    // A chain of single-child branches from `level` down to `node`.
+    static IntrusivePtr<Node> NewPath(unsigned level, IntrusivePtr<Node> node) {
+        for (; level > 0; level -= kBits) {
+            auto branch = MakeIntrusive<Branch>();
+            branch->children[0] = std::move(node);
+            node = std::move(branch);
+        }
+        return node;
+    }
+
+    // Appends the full `tail` as the leaf holding elements `[size_ - kWidth, size_)`.
+    void PushTail(unsigned level, IntrusivePtr<Node>& slot, IntrusivePtr<Node> tail) {
+        Branch* parent = MakeWritable<Branch>(slot);
+        IntrusivePtr<Node>& child = parent->children[((size_ - 1) >> level) & kMask];
+        if (level == kBits) {
+            child = std::move(tail);
+        } else if (child) {
+            PushTail(level - kBits, child, std::move(tail));
+        } else {
+            child = NewPath(level - kBits, std::move(tail));
+        }
+    }
+
+    // Drops the last leaf of the trie, and the branches it leaves empty.
+    void PopTail(unsigned level, IntrusivePtr<Node>& slot) {
+        size_t index = ((size_ - 2) >> level) & kMask;
+        if (level > kBits) {
+            Branch* parent = MakeWritable<Branch>(slot);
+            PopTail(level - kBits, parent->children[index]);
+            if (index == 0 && !parent->children[0]) {
+                slot.Reset();
+            }
+        } else if (index == 0) {
+            slot.Reset();
+        } else {
+            MakeWritable<Branch>(slot)->children[index].Reset();
+        }
+    }
+
+    IntrusivePtr<Node> root_;
+    IntrusivePtr<Node> tail_;
+    size_t size_ = 0;
+    unsigned shift_ = kBits;
+};
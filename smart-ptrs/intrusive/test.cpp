@@ -1,10 +1,16 @@
 #include "intrusive.h"
+#include "object_pool.h"
 
 #include <catch.hpp>
 
 #include "allocations_checker.h"
 
+#include <common/pointer_hash.h>
+
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -19,6 +25,13 @@ struct MyString : public SimpleRefCounted<MyString>, public std::string {
     using std::string::basic_string;
 };
 
+// Empty pointers are constant-initialized: no dynamic initializer runs for these globals.
+constinit IntrusivePtr<MyInt> global_intrusive;
+constinit IntrusivePtr<MyInt> global_null_intrusive = nullptr;
+
+static_assert(!IntrusivePtr<MyInt>());
+static_assert(IntrusivePtr<MyInt>(nullptr).Get() == nullptr);
+
 TEST_CASE("Empty") {
     SECTION("Sizeof") {
         REQUIRE(sizeof(IntrusivePtr<MyInt>) == sizeof(void*));
@@ -35,6 +48,14 @@ TEST_CASE("Empty") {
         REQUIRE(b.Get() == nullptr);
         REQUIRE(c.Get() == nullptr);
     }
+
+    SECTION("Constant-initialized globals") {
+        REQUIRE(!global_intrusive);
+        REQUIRE(!global_null_intrusive);
+        global_intrusive = MakeIntrusive<MyInt>(1);
+        REQUIRE(global_intrusive->value == 1);
+        global_intrusive.Reset();
+    }
 }
 
 TEST_CASE("Copy/move") {
@@ -274,81 +295,6 @@ TEST_CASE("No copies") {
     IntrusivePtr<Pinned> p(new Pinned(1));
 }
 
-template <typename T>
-class ObjectInPool;
-
-template <typename T>
-class ObjectPool {
-    static_assert(std::is_base_of_v<ObjectInPool<T>, T>, "Unsupported type");
-
-public:
-    template <typename... Args>
-    IntrusivePtr<T> Allocate(Args&&... args) {
-        if (!objects_.empty()) {
-            std::unique_ptr<T> ptr = std::move(objects_.back());
-            objects_.pop_back();
-            return IntrusivePtr<T>(ptr.release());
-        }
-        return DoAllocate(std::forward<Args>(args)...);
-    }
-
-    void Release(T* ptr) {
-        objects_.emplace_back(ptr);
-    }
-
-    size_t NumAvailable() const {
-        return objects_.size();
-    }
-
-    size_t NumInUse() const {
-        return allocated_ - NumAvailable();
-    }
-
-private:
-    template <typename... Args>
-    IntrusivePtr<T> DoAllocate(Args&&... args) {
-        ++allocated_;
-        std::unique_ptr<T> object = std::make_unique<T>(std::forward<Args>(args)...);
-        object->SetHome(this);
-        return IntrusivePtr<T>(object.release());
-    }
-
-private:
-    std::vector<std::unique_ptr<T>> objects_;
-    size_t allocated_ = 0;
-};
-
-template <typename Derived>
-class ObjectInPool {
-public:
-    void IncRef() {
-        count_++;
-    }
-
-    void DecRef() {
-        if (--count_ == 0) {
-            TakeMeHome();
-        }
-    }
-
-    size_t RefCount() const {
-        return count_;
-    }
-
-    void SetHome(ObjectPool<Derived>* pool) {
-        home_ = pool;
-    }
-
-private:
-    void TakeMeHome() {
-        home_->Release(static_cast<Derived*>(this));
-    }
-
-private:
-    size_t count_ = 0;
-    ObjectPool<Derived>* home_;
-};
-
 struct PoolableString : ObjectInPool<PoolableString>, std::string {
     using std::string::basic_string;
 };
@@ -397,3 +343,253 @@ TEST_CASE("Object pool") {
         REQUIRE(strs.NumInUse() == 1);
     }
 }
+
+TEST_CASE("Object pool policies") {
+    SECTION("Capacity") {
+        ObjectPool<PoolableString> strs(2);
+        {
+            auto a = strs.Allocate("a");
+            auto b = strs.Allocate("b");
+            auto c = strs.Allocate("c");
+        }
+        REQUIRE(strs.NumAvailable() == 2);
+        REQUIRE(strs.GetStats().high_water_mark == 3);
+    }
+
+    SECTION("Reserve and trim") {
+        ObjectPool<PoolableString> strs;
+        strs.Reserve(3, "warm");
+        REQUIRE(strs.NumAvailable() == 3);
+        EXPECT_ZERO_ALLOCATIONS(auto a = strs.Allocate(); REQUIRE(*a == "warm"););
+        strs.Trim(1);
+        REQUIRE(strs.NumAvailable() == 1);
+        strs.Trim();
+        REQUIRE(strs.NumAvailable() == 0);
+    }
+
+    SECTION("Reset hook") {
+        ObjectPool<PoolableString> strs(ObjectPool<PoolableString>::kUnbounded,
+                                        [](PoolableString& str) { str.clear(); });
+        strs.Allocate("dirty");
+        REQUIRE(strs.Allocate("ignored")->empty());
+    }
+
+    SECTION("Stats") {
+        ObjectPool<PoolableString> strs;
+        {
+            auto a = strs.Allocate();
+            auto b = strs.Allocate();
+        }
+        auto a = strs.Allocate();
+        const auto& stats = strs.GetStats();
+        REQUIRE(stats.misses == 2);
+        REQUIRE(stats.hits == 1);
+        REQUIRE(stats.in_use == 1);
+        REQUIRE(stats.available == 1);
+        REQUIRE(stats.high_water_mark == 2);
+    }
+
+    SECTION("Thread-safe counter") {
+        struct Node : ObjectInPool<Node, ThreadSafeCounter> {
+            int value = 0;
+        };
+        ObjectPool<Node> nodes;
+        IntrusivePtr<Node> node = nodes.Allocate();
+        IntrusivePtr<Node> copy = node;
+        node.Reset();
+        REQUIRE(nodes.NumInUse() == 1);
+        copy.Reset();
+        REQUIRE(nodes.NumAvailable() == 1);
+    }
+}
+
+TEST_CASE("Hashing") {
+    auto a = MakeIntrusive<MyString>("a");
+    auto b = MakeIntrusive<MyString>("b");
+    IntrusivePtr<MyString> a_copy = a;
+
+    SECTION("Owner-based") {
+        REQUIRE(a.OwnerEqual(a_copy));
+        REQUIRE(!a.OwnerEqual(b));
+        REQUIRE(a.OwnerHash() == a_copy.OwnerHash());
+        REQUIRE(a.OwnerBefore(b) != b.OwnerBefore(a));
+    }
+
+    SECTION("Owner-based through a second base") {
+        struct Counted : SimpleRefCounted<Counted> {
+            virtual ~Counted() = default;
+        };
+        struct Tag {
+            virtual ~Tag() = default;
+            int tag = 0;
+        };
+        struct TwoBases : Tag, Counted {};
+
+        auto derived = MakeIntrusive<TwoBases>();
+        IntrusivePtr<Counted> base = derived;
+        REQUIRE(static_cast<const void*>(base.Get()) != static_cast<const void*>(derived.Get()));
+        REQUIRE(base.OwnerEqual(derived));
+        REQUIRE(derived.OwnerEqual(base));
+        REQUIRE(base.OwnerHash() == derived.OwnerHash());
+        REQUIRE(!base.OwnerBefore(derived));
+        REQUIRE(!derived.OwnerBefore(base));
+        REQUIRE(!base.OwnerEqual(a));
+    }
+
+    SECTION("std::hash") {
+        std::unordered_set<IntrusivePtr<MyString>> set{a, b};
+        REQUIRE(set.count(a_copy) == 1);
+        REQUIRE(a == a_copy);
+    }
+
+    SECTION("Heterogeneous lookup by raw pointer") {
+        std::unordered_set<IntrusivePtr<MyString>, PointerHash, PointerEqual> set{a, b};
+        REQUIRE(a.UseCount() == 3);
+        REQUIRE(set.contains(a.Get()));
+        REQUIRE(a.UseCount() == 3);
+        MyString unknown{"c"};
+        REQUIRE(!set.contains(&unknown));
+    }
+}
+
+TEST_CASE("Thread-safe counter") {
+    struct SharedString : ThreadSafeRefCounted<SharedString>,
+                          ObjectCounters<SharedString>,
+                          std::string {
+        using std::string::basic_string;
+    };
+
+    SECTION("Sizeof") {
+        static_assert(sizeof(ThreadSafeCounter) == sizeof(size_t));
+        REQUIRE(sizeof(IntrusivePtr<SharedString>) == sizeof(void*));
+    }
+
+    SECTION("Copies from many threads") {
+        SharedString::ResetCounters();
+        constexpr int kThreads = 4;
+        constexpr int kIterations = 10000;
+        {
+            auto root = MakeIntrusive<SharedString>("shared");
+            std::vector<std::thread> threads;
+            for (int t = 0; t < kThreads; ++t) {
+                threads.emplace_back([root] {
+                    std::vector<IntrusivePtr<SharedString>> copies;
+                    for (int i = 0; i < kIterations; ++i) {
+                        copies.push_back(root);
+                        if (copies.size() == 16) {
+                            copies.clear();
+                        }
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            REQUIRE(root.UseCount() == 1);
+            REQUIRE(*root == "shared");
+        }
+        REQUIRE(SharedString::NumCreated() == 1);
+        REQUIRE(SharedString::NumAlive() == 0);
+    }
+
+    SECTION("Last owner on another thread destroys") {
+        SharedString::ResetCounters();
+        auto ptr = MakeIntrusive<SharedString>("moved");
+        std::thread([owned = std::move(ptr)]() mutable { owned.Reset(); }).join();
+        REQUIRE(SharedString::NumAlive() == 0);
+    }
+}
+
+TEST_CASE("Counter width and immortal objects") {
+    SECTION("Sizeof") {
+        struct Small : RefCounted<Small, BasicSimpleCounter<uint16_t>, DefaultDelete> {
+            uint16_t value = 0;
+        };
+        static_assert(sizeof(BasicSimpleCounter<uint16_t>) == 2);
+        static_assert(sizeof(BasicThreadSafeCounter<uint32_t>) == 4);
+        static_assert(sizeof(Small) == 4);
+        auto small = MakeIntrusive<Small>();
+        IntrusivePtr<Small> copy = small;
+        REQUIRE(small.UseCount() == 2);
+    }
+
+    SECTION("Saturation") {
+        BasicSimpleCounter<uint8_t> counter;
+        for (int i = 0; i < 1000; ++i) {
+            counter.IncRef();
+        }
+        REQUIRE(counter.IsImmortal());
+        for (int i = 0; i < 1000; ++i) {
+            REQUIRE(counter.DecRef() != 0);
+        }
+
+        BasicThreadSafeCounter<uint8_t> shared;
+        for (int i = 0; i < 1000; ++i) {
+            shared.IncRef();
+        }
+        REQUIRE(shared.IsImmortal());
+        REQUIRE(shared.IncRefIfNotZero());
+    }
+
+    SECTION("Saturation is sticky") {
+        using Traits = CounterTraits<uint16_t>;
+        BasicThreadSafeCounter<uint16_t> counter;
+        while (counter.RefCount() + 1 < Traits::kImmortalBit) {
+            counter.IncRef();
+        }
+        REQUIRE(!counter.IsImmortal());
+        // The increment landing on the bit moves the count to the middle of the immortal range.
+        REQUIRE(counter.IncRef() == Traits::kImmortal);
+        REQUIRE(counter.RefCount() == Traits::kImmortal);
+        REQUIRE(counter.DecRef() == Traits::kImmortal);
+    }
+
+    SECTION("Racing saturation") {
+        using Traits = CounterTraits<uint16_t>;
+        constexpr int kThreads = 4;
+        constexpr int kPairs = 1000;
+        for (int round = 0; round < 20; ++round) {
+            BasicThreadSafeCounter<uint16_t> counter;
+            while (counter.RefCount() + 2 < Traits::kImmortalBit) {
+                counter.IncRef();
+            }
+            // Balanced increments and decrements around the bit: once the count saturates it
+            // must stay immortal, otherwise it must end where it started.
+            std::vector<std::thread> threads;
+            for (int t = 0; t < kThreads; ++t) {
+                threads.emplace_back([&counter] {
+                    for (int i = 0; i < kPairs; ++i) {
+                        counter.IncRef();
+                        counter.DecRef();
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            REQUIRE((counter.IsImmortal() || counter.RefCount() == Traits::kImmortalBit - 2));
+        }
+    }
+
+    SECTION("Immortal static") {
+        // A static is never deleted, whatever the count says.
+        struct KeepAlive {
+            static void Destroy(void*) {
+            }
+        };
+        struct Interned : ThreadSafeRefCounted<Interned, KeepAlive> {
+            int value = 42;
+        };
+        static Interned interned;
+        interned.MakeImmortal();
+        size_t count = interned.RefCount();
+        {
+            IntrusivePtr<Interned> first(&interned);
+            IntrusivePtr<Interned> second = first;
+            second.Reset();
+        }
+        REQUIRE(interned.IsImmortal());
+        REQUIRE(interned.RefCount() == count);
+        REQUIRE(interned.value == 42);
+    }
+}
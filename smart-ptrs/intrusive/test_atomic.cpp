@@ -0,0 +1,124 @@
+#include "atomic_intrusive.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Version : ThreadSafeRefCounted<Version> {
+    explicit Version(int value) : value{value}, check{-value} {
+        ++alive;
+    }
+
+    ~Version() {
+        value = check = 0;
+        --alive;
+    }
+
+    int value;
+    int check;
+
+    static inline std::atomic<int> alive = 0;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("AtomicIntrusivePtr") {
+    SECTION("Empty") {
+        AtomicIntrusivePtr<Version> slot;
+        REQUIRE(!slot.Load());
+        REQUIRE(AtomicIntrusivePtr<Version>::IsLockFree());
+    }
+
+    SECTION("Only thread-safe counters are accepted") {
+        struct Local : SimpleRefCounted<Local> {};
+        static_assert(Version::kThreadSafeCount);
+        static_assert(!Local::kThreadSafeCount);
+    }
+
+    SECTION("Load/Store/Exchange") {
+        auto first = MakeIntrusive<Version>(1);
+        AtomicIntrusivePtr<Version> slot(first);
+        REQUIRE(first.UseCount() == 2);
+        REQUIRE(slot.Load() == first);
+        REQUIRE(first.UseCount() == 2);
+
+        auto previous = slot.Exchange(MakeIntrusive<Version>(2));
+        REQUIRE(previous == first);
+        REQUIRE(first.UseCount() == 2);
+        REQUIRE(slot.Load()->value == 2);
+
+        slot.Store(nullptr);
+        REQUIRE(!slot.Load());
+        REQUIRE(Version::alive == 1);
+    }
+
+    SECTION("CompareExchange") {
+        auto first = MakeIntrusive<Version>(1);
+        auto second = MakeIntrusive<Version>(2);
+        AtomicIntrusivePtr<Version> slot(first);
+
+        IntrusivePtr<Version> expected = second;
+        REQUIRE(!slot.CompareExchange(expected, second));
+        REQUIRE(expected == first);
+
+        REQUIRE(slot.CompareExchange(expected, second));
+        REQUIRE(slot.Load() == second);
+        REQUIRE(first.UseCount() == 2);
+        REQUIRE(second.UseCount() == 2);
+    }
+
+    REQUIRE(Version::alive == 0);
+}
+
+TEST_CASE("AtomicIntrusivePtr stress") {
+    constexpr int kReaders = 4;
+    constexpr int kWriters = 2;
+    constexpr int kIterations = 20'000;
+
+    {
+        AtomicIntrusivePtr<Version> slot(MakeIntrusive<Version>(1));
+        std::atomic<int> corrupted = 0;
+        std::atomic<int> next_value = 2;
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < kReaders; ++t) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < kIterations; ++i) {
+                    IntrusivePtr<Version> version = slot.Load();
+                    if (!version || version->value != -version->check) {
+                        ++corrupted;
+                    }
+                }
+            });
+        }
+        for (int t = 0; t < kWriters; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < kIterations; ++i) {
+                    auto version = MakeIntrusive<Version>(next_value++);
+                    if (t == 0) {
+                        slot.Store(version);
+                        continue;
+                    }
+                    IntrusivePtr<Version> expected = slot.Load();
+                    while (!slot.CompareExchange(expected, version)) {
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(corrupted == 0);
+        REQUIRE(Version::alive == 1);
+    }
+    REQUIRE(Version::alive == 0);
+}
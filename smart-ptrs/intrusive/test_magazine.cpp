@@ -0,0 +1,146 @@
+#include "magazine_pool.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Message : ObjectInMagazinePool<Message> {
+    Message() {
+        ++alive;
+    }
+
+    ~Message() {
+        --alive;
+    }
+
+    int value = 0;
+
+    static inline std::atomic<int> alive = 0;
+};
+
+// Single-producer single-consumer queue of messages, enough to hand objects between threads.
+class Channel {
+public:
+    void Send(IntrusivePtr<Message> message) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        while (tail - head_.load(std::memory_order_acquire) == kSize) {
+            std::this_thread::yield();
+        }
+        slots_[tail % kSize] = message.Release();
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    IntrusivePtr<Message> Receive() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        while (tail_.load(std::memory_order_acquire) == head) {
+            std::this_thread::yield();
+        }
+        Message* message = slots_[head % kSize];
+        head_.store(head + 1, std::memory_order_release);
+        IntrusivePtr<Message> result(message);
+        message->DecRef();
+        return result;
+    }
+
+private:
+    static constexpr size_t kSize = 256;
+
+    Message* slots_[kSize];
+    std::atomic<size_t> head_ = 0;
+    std::atomic<size_t> tail_ = 0;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("Magazine pool") {
+    SECTION("Reuse on one thread") {
+        MagazinePool<Message> pool;
+        Message* first = pool.Allocate().Get();
+        IntrusivePtr<Message> second = pool.Allocate();
+        REQUIRE(second.Get() == first);
+        REQUIRE(pool.NumCreated() == 1);
+        REQUIRE(pool.NumMagazines() == 1);
+    }
+
+    SECTION("Magazines move through the depot") {
+        MagazinePool<Message> pool;
+        std::vector<IntrusivePtr<Message>> messages;
+        for (size_t i = 0; i < 3 * MagazinePool<Message>::kRounds; ++i) {
+            messages.push_back(pool.Allocate());
+        }
+        messages.clear();
+        REQUIRE(pool.NumMagazines() == 3);
+        for (size_t i = 0; i < 3 * MagazinePool<Message>::kRounds; ++i) {
+            messages.push_back(pool.Allocate());
+        }
+        REQUIRE(pool.NumCreated() == 3 * MagazinePool<Message>::kRounds);
+    }
+
+    SECTION("Bounded number of magazines") {
+        MagazinePool<Message> pool(1);
+        std::vector<IntrusivePtr<Message>> messages;
+        for (size_t i = 0; i < 2 * MagazinePool<Message>::kRounds; ++i) {
+            messages.push_back(pool.Allocate());
+        }
+        messages.clear();
+        REQUIRE(Message::alive == static_cast<int>(MagazinePool<Message>::kRounds));
+    }
+
+    SECTION("Objects released by a finished thread are reused") {
+        MagazinePool<Message> pool;
+        std::thread([&pool] {
+            for (size_t i = 0; i < 10; ++i) {
+                pool.Allocate();
+            }
+        }).join();
+        pool.Allocate();
+        REQUIRE(pool.NumCreated() == 1);
+    }
+
+    REQUIRE(Message::alive == 0);
+}
+
+TEST_CASE("Magazine pool across threads") {
+    constexpr size_t kMessages = 200'000;
+    MagazinePool<Message> pool;
+    Channel forward;
+    Channel backward;
+    std::atomic<size_t> corrupted = 0;
+
+    // The producer allocates and the consumer releases; half of the messages come back to be
+    // released by the producer, so both threads return objects to the depot.
+    std::thread producer([&] {
+        for (size_t i = 0; i < kMessages; ++i) {
+            IntrusivePtr<Message> message = pool.Allocate();
+            message->value = static_cast<int>(i);
+            forward.Send(std::move(message));
+            if (i % 2 == 1) {
+                backward.Receive();
+            }
+        }
+    });
+    std::thread consumer([&] {
+        for (size_t i = 0; i < kMessages; ++i) {
+            IntrusivePtr<Message> message = forward.Receive();
+            if (message->value != static_cast<int>(i)) {
+                ++corrupted;
+            }
+            if (i % 2 == 0) {
+                backward.Send(std::move(message));
+            }
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    REQUIRE(corrupted == 0);
+    REQUIRE(pool.NumCreated() < kMessages / 10);
+}
@@ -0,0 +1,273 @@
+#include "persistent_map.h"
+#include "persistent_vector.h"
+
+#include <catch.hpp>
+
+#include "allocations_checker.h"
+
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+template <typename T>
+std::vector<T> Elements(const PersistentVector<T>& vector) {
+    std::vector<T> result;
+    vector.ForEach([&](const T& value) { result.push_back(value); });
+    return result;
+}
+
+template <typename K, typename V, typename H>
+std::unordered_map<K, V> Entries(const PersistentHashMap<K, V, H>& map) {
+    std::unordered_map<K, V> result;
+    map.ForEach([&](const K& key, const V& value) { result.emplace(key, value); });
+    return result;
+}
+
+// Every key collides with every other one in all hash bits.
+struct ConstantHash {
+    size_t operator()(int) const {
+        return 42;
+    }
+};
+
+// Keys collide in the low bits only, so they share deep paths.
+struct HighBitsHash {
+    size_t operator()(int key) const {
+        return size_t(key) << 40;
+    }
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// PersistentVector
+
+TEST_CASE("PersistentVector grows and shrinks through several levels") {
+    constexpr int kSize = 40'000;  // A root three branches above the leaves.
+    PersistentVector<int> vector;
+    for (int i = 0; i < kSize; ++i) {
+        vector = std::move(vector).PushBack(i);
+    }
+    REQUIRE(vector.Size() == kSize);
+    for (int i = 0; i < kSize; ++i) {
+        REQUIRE(vector[i] == i);
+    }
+    REQUIRE(vector.Back() == kSize - 1);
+
+    for (int i = kSize; i > 0; --i) {
+        REQUIRE(vector.Back() == i - 1);
+        vector = std::move(vector).PopBack();
+    }
+    REQUIRE(vector.Empty());
+    REQUIRE_THROWS_AS(vector.PopBack(), std::out_of_range);
+}
+
+TEST_CASE("PersistentVector versions are independent") {
+    PersistentVector<std::string> empty;
+    auto one = empty.PushBack("one");
+    auto two = one.PushBack("two");
+    auto changed = two.Set(0, "changed");
+    auto popped = changed.PopBack();
+
+    REQUIRE(empty.Empty());
+    REQUIRE(Elements(one) == std::vector<std::string>{"one"});
+    REQUIRE(Elements(two) == std::vector<std::string>{"one", "two"});
+    REQUIRE(Elements(changed) == std::vector<std::string>{"changed", "two"});
+    REQUIRE(Elements(popped) == std::vector<std::string>{"changed"});
+
+    REQUIRE_THROWS_AS(two.At(2), std::out_of_range);
+    REQUIRE_THROWS_AS(two.Set(2, "three"), std::out_of_range);
+}
+
+TEST_CASE("PersistentVector matches std::vector at every version") {
+    std::mt19937 gen(7);
+    std::vector<PersistentVector<int>> versions(1);
+    std::vector<std::vector<int>> expected(1);
+    for (int step = 0; step < 5'000; ++step) {
+        PersistentVector<int> next;
+        std::vector<int> model = expected.back();
+        const auto& last = versions.back();
+        size_t action = gen() % 4;
+        if (action == 0 && !model.empty()) {
+            next = last.PopBack();
+            model.pop_back();
+        } else if (action == 1 && !model.empty()) {
+            size_t index = gen() % model.size();
+            next = last.Set(index, step);
+            model[index] = step;
+        } else {
+            next = last.PushBack(step);
+            model.push_back(step);
+        }
+        versions.push_back(std::move(next));
+        expected.push_back(std::move(model));
+    }
+    for (size_t i = 0; i < versions.size(); i += 97) {
+        REQUIRE(Elements(versions[i]) == expected[i]);
+    }
+    REQUIRE(Elements(versions.back()) == expected.back());
+}
+
+TEST_CASE("PersistentVector updates unshared nodes in place") {
+    PersistentVector<int> vector;
+    for (int i = 0; i < 5'000; ++i) {
+        vector = std::move(vector).PushBack(i);
+    }
+
+    const int* element = &vector[1234];
+    EXPECT_ZERO_ALLOCATIONS(vector = std::move(vector).Set(1234, -1));
+    REQUIRE(&vector[1234] == element);
+    REQUIRE(vector[1234] == -1);
+
+    // A snapshot shares the path: the next update copies it, and only it.
+    auto snapshot = vector;
+    vector = std::move(vector).Set(1234, -2);
+    REQUIRE(&vector[1234] != element);
+    REQUIRE(&vector[2000] == &snapshot[2000]);
+    REQUIRE(&vector[0] == &snapshot[0]);
+    REQUIRE(snapshot[1234] == -1);
+    REQUIRE(vector[1234] == -2);
+
+    // Tail updates are in place as well.
+    vector = std::move(vector).PushBack(1);
+    EXPECT_ZERO_ALLOCATIONS(vector = std::move(vector).PushBack(2));
+}
+
+TEST_CASE("PersistentVector versions shared between threads") {
+    PersistentVector<int> base;
+    for (int i = 0; i < 10'000; ++i) {
+        base = std::move(base).PushBack(i);
+    }
+
+    constexpr int kThreads = 4;
+    std::vector<PersistentVector<int>> results(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            PersistentVector<int> mine = base;
+            for (int i = t; i < 10'000; i += kThreads) {
+                mine = std::move(mine).Set(i, -i);
+            }
+            results[t] = std::move(mine);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 0; i < 10'000; ++i) {
+        REQUIRE(base[i] == i);
+        for (int t = 0; t < kThreads; ++t) {
+            REQUIRE(results[t][i] == (i % kThreads == t ? -i : i));
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// PersistentHashMap
+
+TEST_CASE("PersistentHashMap inserts, assigns and erases") {
+    PersistentHashMap<std::string, int> empty;
+    auto one = empty.Set("one", 1);
+    auto two = one.Set("two", 2);
+    auto assigned = two.Set("one", 10);
+    auto erased = assigned.Erase("two");
+
+    REQUIRE(empty.Empty());
+    REQUIRE(!empty.Find("one"));
+    REQUIRE(one.Size() == 1);
+    REQUIRE(*one.Find("one") == 1);
+    REQUIRE(two.Size() == 2);
+    REQUIRE(*two.Find("one") == 1);
+    REQUIRE(assigned.Size() == 2);
+    REQUIRE(*assigned.Find("one") == 10);
+    REQUIRE(erased.Size() == 1);
+    REQUIRE(!erased.Contains("two"));
+    REQUIRE(two.Contains("two"));
+
+    auto unchanged = erased.Erase("missing");
+    REQUIRE(unchanged.Size() == 1);
+    REQUIRE(Entries(unchanged) == Entries(erased));
+}
+
+TEST_CASE("PersistentHashMap matches std::unordered_map at every version") {
+    std::mt19937 gen(11);
+    std::vector<PersistentHashMap<int, int>> versions(1);
+    std::vector<std::unordered_map<int, int>> expected(1);
+    for (int step = 0; step < 5'000; ++step) {
+        int key = gen() % 2'000;
+        std::unordered_map<int, int> model = expected.back();
+        if (gen() % 3 == 0) {
+            versions.push_back(versions.back().Erase(key));
+            model.erase(key);
+        } else {
+            versions.push_back(versions.back().Set(key, step));
+            model[key] = step;
+        }
+        expected.push_back(std::move(model));
+    }
+    for (size_t i = 0; i < versions.size(); i += 97) {
+        REQUIRE(versions[i].Size() == expected[i].size());
+        REQUIRE(Entries(versions[i]) == expected[i]);
+    }
+    REQUIRE(Entries(versions.back()) == expected.back());
+}
+
+TEST_CASE("PersistentHashMap with colliding hashes") {
+    PersistentHashMap<int, int, ConstantHash> colliding;
+    PersistentHashMap<int, int, HighBitsHash> deep;
+    for (int key = 0; key < 100; ++key) {
+        colliding = std::move(colliding).Set(key, key);
+        deep = std::move(deep).Set(key, key);
+    }
+    for (int key = 0; key < 100; ++key) {
+        REQUIRE(*colliding.Find(key) == key);
+        REQUIRE(*deep.Find(key) == key);
+    }
+    REQUIRE(!colliding.Find(100));
+    REQUIRE(!deep.Find(100));
+
+    for (int key = 0; key < 100; key += 2) {
+        colliding = std::move(colliding).Erase(key);
+        deep = std::move(deep).Erase(key);
+    }
+    REQUIRE(colliding.Size() == 50);
+    REQUIRE(deep.Size() == 50);
+    for (int key = 0; key < 100; ++key) {
+        REQUIRE(colliding.Contains(key) == (key % 2 == 1));
+        REQUIRE(deep.Contains(key) == (key % 2 == 1));
+    }
+
+    for (int key = 1; key < 100; key += 2) {
+        colliding = std::move(colliding).Erase(key);
+        deep = std::move(deep).Erase(key);
+    }
+    REQUIRE(colliding.Empty());
+    REQUIRE(deep.Empty());
+}
+
+TEST_CASE("PersistentHashMap updates unshared nodes in place") {
+    PersistentHashMap<int, int> map;
+    for (int key = 0; key < 5'000; ++key) {
+        map = std::move(map).Set(key, key);
+    }
+
+    const int* value = map.Find(1234);
+    EXPECT_ZERO_ALLOCATIONS(map = std::move(map).Set(1234, -1));
+    REQUIRE(map.Find(1234) == value);
+    REQUIRE(*value == -1);
+
+    auto snapshot = map;
+    map = std::move(map).Set(1234, -2);
+    REQUIRE(map.Find(1234) != value);
+    REQUIRE(*snapshot.Find(1234) == -1);
+    REQUIRE(*map.Find(1234) == -2);
+    // Everything off the path is still shared.
+    REQUIRE(map.Find(1235) == snapshot.Find(1235));
+}
@@ -0,0 +1,145 @@
+#include "intrusive_weak.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Node : SimpleWeakRefCounted<Node> {
+    explicit Node(int value) : value{value} {
+    }
+
+    virtual ~Node() {
+        ++destroyed;
+    }
+
+    int value = 0;
+    IntrusiveWeakPtr<Node> parent;
+
+    static inline int destroyed = 0;
+};
+
+struct Leaf : Node {
+    using Node::Node;
+};
+
+struct ObservedByDestructor : SimpleWeakRefCounted<ObservedByDestructor> {
+    ~ObservedByDestructor() {
+        locked_in_destructor = static_cast<bool>(self.Lock());
+        expired_in_destructor = self.Expired();
+    }
+
+    IntrusiveWeakPtr<ObservedByDestructor> self;
+
+    static inline bool locked_in_destructor = true;
+    static inline bool expired_in_destructor = false;
+};
+
+struct SharedNode : ThreadSafeWeakRefCounted<SharedNode> {
+    int value = 42;
+};
+
+}  // namespace
+
+TEST_CASE("IntrusiveWeakPtr") {
+    Node::destroyed = 0;
+
+    SECTION("Sizeof") {
+        static_assert(sizeof(IntrusiveWeakPtr<Node>) == sizeof(void*));
+        // One pointer-sized slot on top of the plain intrusive counter.
+        struct Plain : SimpleRefCounted<Plain> {};
+        struct Weak : SimpleWeakRefCounted<Weak> {};
+        static_assert(sizeof(Weak) == sizeof(Plain) + sizeof(void*));
+    }
+
+    SECTION("Lock while alive, expire after") {
+        auto node = MakeIntrusive<Node>(1);
+        IntrusiveWeakPtr<Node> weak(node);
+        REQUIRE(!weak.Expired());
+        REQUIRE(weak.UseCount() == 1);
+
+        auto locked = weak.Lock();
+        REQUIRE(locked.Get() == node.Get());
+        REQUIRE(node.UseCount() == 2);
+
+        locked.Reset();
+        node.Reset();
+        REQUIRE(Node::destroyed == 1);
+        REQUIRE(weak.Expired());
+        REQUIRE(!weak.Lock());
+    }
+
+    SECTION("Back references") {
+        auto parent = MakeIntrusive<Node>(1);
+        auto child = MakeIntrusive<Node>(2);
+        child->parent = parent;
+        REQUIRE(child->parent.Lock()->value == 1);
+        parent.Reset();
+        REQUIRE(Node::destroyed == 1);
+        REQUIRE(!child->parent.Lock());
+    }
+
+    SECTION("Copies and conversions") {
+        auto leaf = MakeIntrusive<Leaf>(3);
+        IntrusiveWeakPtr<Leaf> weak_leaf(leaf);
+        IntrusiveWeakPtr<Node> weak_node(weak_leaf);
+        IntrusiveWeakPtr<Node> moved(std::move(weak_node));
+        IntrusiveWeakPtr<Node> copy;
+        copy = moved;
+        REQUIRE(copy.Lock()->value == 3);
+        REQUIRE(weak_leaf.Lock().Get() == leaf.Get());
+        REQUIRE(!weak_node.Lock());
+        leaf.Reset();
+        REQUIRE(copy.Expired());
+        REQUIRE(moved.Expired());
+    }
+
+    SECTION("Empty") {
+        IntrusiveWeakPtr<Node> weak;
+        REQUIRE(weak.Expired());
+        REQUIRE(!weak.Lock());
+        IntrusiveWeakPtr<Node> from_null{IntrusivePtr<Node>()};
+        REQUIRE(from_null.Expired());
+    }
+
+    SECTION("Destructor sees itself expired") {
+        auto object = MakeIntrusive<ObservedByDestructor>();
+        object->self = object;
+        object.Reset();
+        REQUIRE(!ObservedByDestructor::locked_in_destructor);
+        REQUIRE(ObservedByDestructor::expired_in_destructor);
+    }
+}
+
+TEST_CASE("IntrusiveWeakPtr across threads") {
+    constexpr int kThreads = 4;
+    constexpr int kRounds = 200;
+
+    std::atomic<int> corrupted = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        auto node = MakeIntrusive<SharedNode>();
+        IntrusiveWeakPtr<SharedNode> weak(node);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([weak, &corrupted] {
+                for (int i = 0; i < 100; ++i) {
+                    if (auto locked = weak.Lock()) {
+                        corrupted += locked->value != 42;
+                    }
+                }
+            });
+        }
+        node.Reset();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(weak.Expired());
+    }
+    REQUIRE(corrupted == 0);
+}
@@ -0,0 +1,98 @@
+#include <common/ptr_vector.h>
+#include <shared-from-this/shared.h>
+#include <unique/unique.h>
+
+#include <catch.hpp>
+
+#include <common/bench.h>
+
+#include <cstdio>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr size_t kGrowth = 1'000'000;
+constexpr size_t kErased = 20'000;
+constexpr size_t kTable = 4'000'000;
+
+// Thin adapter, so one benchmark body serves both containers.
+template <typename P>
+struct StdVector : std::vector<P> {
+    void PushBack(P value) {
+        this->push_back(std::move(value));
+    }
+    void Erase(P* position) {
+        this->erase(std::vector<P>::begin() + (position - this->data()));
+    }
+    P* begin() {
+        return this->data();
+    }
+    size_t Size() const {
+        return this->size();
+    }
+};
+
+template <typename Vector, typename Make>
+void Growth(const char* name, Make make) {
+    MeasureBatchNsPerOp(name, kGrowth, [&] {
+        Vector vector;
+        for (size_t i = 0; i < kGrowth; ++i) {
+            vector.PushBack(make());
+        }
+        DoNotOptimize(vector.Size());
+    });
+}
+
+// Erasing the front shifts every element down by one.
+template <typename Vector, typename Make>
+void EraseFront(const char* name, Make make) {
+    Vector vector;
+    for (size_t i = 0; i < kErased; ++i) {
+        vector.PushBack(make());
+    }
+    MeasureBatchNsPerOp(name, kErased * kErased / 2, [&] {
+        while (vector.Size() != 0) {
+            vector.Erase(vector.begin());
+        }
+    });
+}
+
+// A sparse table: one pointer in 64 is set.
+template <typename Vector>
+void DestroySparse(const char* name, const SharedPtr<int>& value) {
+    auto* vector = new Vector;
+    for (size_t i = 0; i < kTable; ++i) {
+        vector->PushBack(i % 64 == 0 ? value : nullptr);
+    }
+    MeasureBatchNsPerOp(name, kTable, [vector] { delete vector; });
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("PtrVector vs std::vector", "[.][bench]") {
+    auto shared = MakeShared<int>(1);
+    auto make_shared = [&shared] { return shared; };
+    auto make_unique = [] { return UniquePtr<int>(new int(1)); };
+
+    std::printf("PushBack without Reserve, per element:\n");
+    Growth<StdVector<SharedPtr<int>>>("std::vector<SharedPtr>", make_shared);
+    Growth<PtrVector<SharedPtr<int>>>("PtrVector<SharedPtr>", make_shared);
+    Growth<StdVector<UniquePtr<int>>>("std::vector<UniquePtr>", make_unique);
+    Growth<PtrVector<UniquePtr<int>>>("PtrVector<UniquePtr>", make_unique);
+
+    std::printf("Erase from the front of %zu elements, per shifted element:\n", kErased);
+    EraseFront<StdVector<SharedPtr<int>>>("std::vector<SharedPtr>", make_shared);
+    EraseFront<PtrVector<SharedPtr<int>>>("PtrVector<SharedPtr>", make_shared);
+    EraseFront<StdVector<UniquePtr<int>>>("std::vector<UniquePtr>", make_unique);
+    EraseFront<PtrVector<UniquePtr<int>>>("PtrVector<UniquePtr>", make_unique);
+
+    std::printf("Destroy a table of %zu pointers, 1/64 set, per element:\n", kTable);
+    DestroySparse<StdVector<SharedPtr<int>>>("std::vector<SharedPtr>", shared);
+    DestroySparse<PtrVector<SharedPtr<int>>>("PtrVector<SharedPtr>", shared);
+
+    REQUIRE(shared.UseCount() == 1);
+}
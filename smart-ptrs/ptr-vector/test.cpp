@@ -0,0 +1,200 @@
+#include <common/my_int.h>
+#include <common/ptr_vector.h>
+#include <intrusive/intrusive.h>
+#include <shared-from-this/shared.h>
+#include <unique/deleters.h>
+#include <unique/unique.h>
+
+#include <catch.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Node : SimpleRefCounted<Node> {
+    int value = 0;
+};
+
+auto lambda_deleter = [](int* ptr) { delete ptr; };
+
+// Throws from the copy constructor once `copies_left` runs out.
+struct CopyThrows {
+    CopyThrows() {
+        ++alive;
+    }
+    CopyThrows(const CopyThrows&) {
+        if (copies_left-- == 0) {
+            throw std::runtime_error("copy");
+        }
+        ++alive;
+    }
+    ~CopyThrows() {
+        --alive;
+    }
+
+    static inline int alive = 0;
+    static inline int copies_left = 0;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The trait
+
+static_assert(kIsTriviallyRelocatable<int*>);
+static_assert(kIsTriviallyRelocatable<UniquePtr<int>>);
+static_assert(kIsTriviallyRelocatable<UniquePtr<int[]>>);
+static_assert(kIsTriviallyRelocatable<UniquePtr<int, decltype(lambda_deleter)>>);
+static_assert(kIsTriviallyRelocatable<UniquePtr<int, void (*)(int*)>>);
+static_assert(kIsTriviallyRelocatable<UniquePtr<int, Deleter<int>&>>);
+static_assert(kIsTriviallyRelocatable<SharedPtr<int>>);
+static_assert(kIsTriviallyRelocatable<WeakPtr<int>>);
+static_assert(kIsTriviallyRelocatable<IntrusivePtr<Node>>);
+// A deleter with its own move constructor may keep pointers into itself.
+static_assert(!kIsTriviallyRelocatable<UniquePtr<int, Deleter<int>>>);
+static_assert(!kIsTriviallyRelocatable<std::string>);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("PtrVector") {
+    SECTION("Growth relocates without touching the counters") {
+        auto shared = MakeShared<MyInt>(1);
+        {
+            PtrVector<SharedPtr<MyInt>> vector;
+            for (int i = 0; i < 100; ++i) {
+                vector.PushBack(shared);
+            }
+            REQUIRE(vector.Size() == 100);
+            REQUIRE(vector.Capacity() >= 100);
+            REQUIRE(shared.UseCount() == 101);
+            for (const auto& element : vector) {
+                REQUIRE(element.Get() == shared.Get());
+            }
+        }
+        REQUIRE(shared.UseCount() == 1);
+    }
+
+    SECTION("Insert and erase") {
+        PtrVector<UniquePtr<int>> vector;
+        for (int i = 0; i < 10; ++i) {
+            vector.EmplaceBack(new int(i));
+        }
+        auto* inserted = vector.Insert(vector.begin() + 3, UniquePtr<int>(new int(100)));
+        REQUIRE(**inserted == 100);
+        REQUIRE(vector.Size() == 11);
+        REQUIRE(*vector[2] == 2);
+        REQUIRE(*vector[4] == 3);
+
+        auto* next = vector.Erase(vector.begin() + 3);
+        REQUIRE(**next == 3);
+        next = vector.Erase(vector.begin(), vector.begin() + 5);
+        REQUIRE(**next == 5);
+        REQUIRE(vector.Size() == 5);
+        vector.Insert(vector.end(), UniquePtr<int>(new int(10)));
+        REQUIRE(*vector[5] == 10);
+        vector.PopBack();
+        REQUIRE(*vector[vector.Size() - 1] == 9);
+    }
+
+    SECTION("Erased and cleared elements are destroyed") {
+        PtrVector<IntrusivePtr<Node>> nodes;
+        auto node = MakeIntrusive<Node>();
+        for (int i = 0; i < 8; ++i) {
+            nodes.PushBack(node);
+        }
+        nodes.PushBack(nullptr);
+        nodes.Erase(nodes.begin() + 1, nodes.begin() + 4);
+        REQUIRE(node->RefCount() == 6);
+        nodes.Clear();
+        REQUIRE(node->RefCount() == 1);
+        REQUIRE(nodes.Empty());
+    }
+
+    SECTION("Empty pointers are skipped, aliasing ones are not") {
+        auto owner = MakeShared<MyInt>(1);
+        {
+            PtrVector<SharedPtr<MyInt>> vector;
+            vector.Reserve(4);
+            vector.EmplaceBack();
+            vector.EmplaceBack(owner, nullptr);
+            vector.EmplaceBack();
+            REQUIRE(owner.UseCount() == 2);
+        }
+        REQUIRE(owner.UseCount() == 1);
+    }
+
+    SECTION("Copies and moves") {
+        auto shared = MakeShared<MyInt>(1);
+        PtrVector<SharedPtr<MyInt>> vector;
+        vector.PushBack(shared);
+        PtrVector<SharedPtr<MyInt>> copy = vector;
+        REQUIRE(shared.UseCount() == 3);
+        PtrVector<SharedPtr<MyInt>> moved = std::move(vector);
+        REQUIRE(vector.Empty());
+        REQUIRE(shared.UseCount() == 3);
+        copy = std::move(moved);
+        REQUIRE(shared.UseCount() == 2);
+    }
+
+    SECTION("A throwing copy leaves nothing behind") {
+        {
+            PtrVector<CopyThrows> vector;
+            vector.Reserve(5);
+            for (int i = 0; i < 5; ++i) {
+                vector.EmplaceBack();
+            }
+            CopyThrows::copies_left = 3;
+            REQUIRE_THROWS_AS(PtrVector<CopyThrows>(vector), std::runtime_error);
+            REQUIRE(CopyThrows::alive == 5);
+        }
+        REQUIRE(CopyThrows::alive == 0);
+    }
+
+    SECTION("Elements of a const vector are const") {
+        const PtrVector<SharedPtr<MyInt>> vector;
+        static_assert(std::is_same_v<decltype(vector[0]), const SharedPtr<MyInt>&>);
+        static_assert(std::is_same_v<decltype(vector.begin()), const SharedPtr<MyInt>*>);
+        static_assert(std::is_same_v<decltype(vector.Data()), const SharedPtr<MyInt>*>);
+        REQUIRE(vector.begin() == vector.end());
+    }
+
+    SECTION("Emplacing an element of a full vector into itself") {
+        auto shared = MakeShared<MyInt>(7);
+        PtrVector<SharedPtr<MyInt>> vector;
+        vector.PushBack(shared);
+        while (vector.Size() < vector.Capacity()) {
+            vector.PushBack(nullptr);
+        }
+        vector.EmplaceBack(vector[0]);
+        REQUIRE(vector[vector.Size() - 1] == shared);
+        REQUIRE(shared.UseCount() == 3);
+
+        PtrVector<std::string> strings;
+        strings.PushBack(std::string(40, 'x'));
+        while (strings.Size() < strings.Capacity()) {
+            strings.PushBack("filler");
+        }
+        strings.EmplaceBack(strings[0]);
+        REQUIRE(strings[strings.Size() - 1] == std::string(40, 'x'));
+        REQUIRE(strings[0] == std::string(40, 'x'));
+    }
+
+    SECTION("Types which are not trivially relocatable") {
+        PtrVector<std::string> strings;
+        for (int i = 0; i < 20; ++i) {
+            strings.PushBack(std::string(40, 'a' + i));
+        }
+        strings.Insert(strings.begin(), "first");
+        strings.Erase(strings.begin() + 1, strings.begin() + 3);
+        REQUIRE(strings.Size() == 19);
+        REQUIRE(strings[0] == "first");
+        REQUIRE(strings[1] == std::string(40, 'c'));
+        REQUIRE(strings[18] == std::string(40, 'a' + 19));
+    }
+
+    REQUIRE(MyInt::AliveCount() == 0);
+}
@@ -0,0 +1,60 @@
+#include "shared.h"
+#include "weak.h"
+
+#include <catch.hpp>
+
+#include <common/bench.h>
+
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// A typical callback owner: every dispatched event captures a strong reference to the handler.
+class Handler : public EnableSharedFromThis<Handler> {
+public:
+    void OnEvent(std::vector<SharedPtr<Handler>>* queue) {
+        queue->push_back(SharedFromThis());
+    }
+
+    void OnEventViaWeak(std::vector<SharedPtr<Handler>>* queue) {
+        queue->push_back(WeakFromThis().Lock());
+    }
+
+private:
+    int state_ = 0;
+};
+
+constexpr size_t kIterations = 10'000'000;
+constexpr size_t kBatch = 64;
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("SharedFromThis in a callback loop", "[.][bench]") {
+    auto handler = MakeShared<Handler>();
+    std::vector<SharedPtr<Handler>> queue;
+    queue.reserve(kBatch);
+
+    auto direct = MeasureNsPerOp("SharedFromThis()", kIterations, [&] {
+        handler->OnEvent(&queue);
+        if (queue.size() == kBatch) {
+            queue.clear();
+        }
+    });
+    queue.clear();
+
+    auto via_weak = MeasureNsPerOp("WeakFromThis().Lock()", kIterations, [&] {
+        handler->OnEventViaWeak(&queue);
+        if (queue.size() == kBatch) {
+            queue.clear();
+        }
+    });
+    queue.clear();
+
+    std::printf("sizeof(Handler) = %zu\n", sizeof(Handler));
+    REQUIRE(direct > 0);
+    REQUIRE(via_weak > 0);
+}
@@ -0,0 +1,78 @@
+#include "cow.h"
+
+#include <catch.hpp>
+
+#include <common/bench.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr size_t kLines = 10'000;
+constexpr size_t kOperations = 100'000;
+// One operation in this many edits the document, the others take a snapshot and read it.
+constexpr size_t kWriteEvery = 100;
+
+struct Document {
+    std::vector<std::string> lines;
+};
+
+Document MakeDocument() {
+    Document doc;
+    for (size_t i = 0; i < kLines; ++i) {
+        doc.lines.push_back("line " + std::to_string(i) + " of a large immutable document");
+    }
+    return doc;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("Copy-on-write snapshots", "[.][bench]") {
+    std::printf("snapshot and read a %zu-line document, edit it once every %zu operations:\n",
+                kLines, kWriteEvery);
+
+    MeasureBatchNsPerOp("deep copy per snapshot", kOperations, [] {
+        Document doc = MakeDocument();
+        for (size_t i = 0; i < kOperations; ++i) {
+            if (i % kWriteEvery == 0) {
+                doc.lines[i % kLines] = "edited";
+            } else {
+                Document snapshot = doc;
+                DoNotOptimize(snapshot.lines[i % kLines].size());
+            }
+        }
+    });
+
+    // Readers are done with their snapshots by the time of the edit: it happens in place.
+    MeasureBatchNsPerOp("CowPtr, snapshots released before edits", kOperations, [] {
+        CowPtr<Document> doc(MakeDocument());
+        for (size_t i = 0; i < kOperations; ++i) {
+            if (i % kWriteEvery == 0) {
+                doc.Write().lines[i % kLines] = "edited";
+            } else {
+                CowPtr<Document> snapshot = doc;
+                DoNotOptimize(snapshot->lines[i % kLines].size());
+            }
+        }
+    });
+
+    // The latest snapshot is still held at every edit: each edit clones the document once.
+    MeasureBatchNsPerOp("CowPtr, a snapshot held across edits", kOperations, [] {
+        CowPtr<Document> doc(MakeDocument());
+        CowPtr<Document> latest = doc;
+        for (size_t i = 0; i < kOperations; ++i) {
+            if (i % kWriteEvery == 0) {
+                doc.Write().lines[i % kLines] = "edited";
+            } else {
+                latest = doc;
+                DoNotOptimize(latest->lines[i % kLines].size());
+            }
+        }
+    });
+}
@@ -0,0 +1,93 @@
+#include "shared.h"
+#include "weak.h"
+
+#include <catch.hpp>
+
+#include <common/bench.h>
+#include <common/pointer_hash.h>
+
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Minimal open-addressing set with linear probing; enough to compare probe paths.
+template <typename Key, typename Hash, typename Equal>
+class FlatSet {
+public:
+    explicit FlatSet(size_t capacity) : slots_(RoundUpToPowerOfTwo(capacity * 2)) {
+    }
+
+    void Insert(const Key& key) {
+        size_t index = Hash()(key) & (slots_.size() - 1);
+        while (slots_[index]) {
+            index = (index + 1) & (slots_.size() - 1);
+        }
+        slots_[index] = key;
+    }
+
+    template <typename Probe>
+    bool Contains(const Probe& probe) const {
+        size_t index = Hash()(probe) & (slots_.size() - 1);
+        while (slots_[index]) {
+            if (Equal()(slots_[index], probe)) {
+                return true;
+            }
+            index = (index + 1) & (slots_.size() - 1);
+        }
+        return false;
+    }
+
+private:
+    static size_t RoundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    std::vector<Key> slots_;
+};
+
+struct Object {
+    int payload = 0;
+};
+
+constexpr size_t kSetSize = 1 << 16;
+constexpr size_t kLookups = 10'000'000;
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("Flat hash set lookup by raw pointer", "[.][bench]") {
+    std::vector<SharedPtr<Object>> objects;
+    FlatSet<SharedPtr<Object>, PointerHash, PointerEqual> set(kSetSize);
+    for (size_t i = 0; i < kSetSize; ++i) {
+        objects.push_back(MakeShared<Object>());
+        set.Insert(objects.back());
+    }
+
+    std::vector<SharedPtr<Object>> owners;
+    std::vector<Object*> probes;
+    for (size_t i = 0; i < kSetSize; ++i) {
+        owners.push_back(objects[(i * 7919) % kSetSize]);
+        probes.push_back(owners.back().Get());
+    }
+
+    size_t found = 0;
+    size_t i = 0;
+    MeasureNsPerOp("probe with a SharedPtr key (refcount round trip)", kLookups, [&] {
+        SharedPtr<Object> key = owners[i++ % kSetSize];
+        found += set.Contains(key);
+    });
+
+    i = 0;
+    MeasureNsPerOp("probe with T* (heterogeneous)", kLookups, [&] {
+        found += set.Contains(probes[i++ % kSetSize]);
+    });
+
+    REQUIRE(found == 2 * kLookups);
+}
@@ -0,0 +1,78 @@
+#include "numa.h"
+
+#include <catch.hpp>
+
+#include <common/bench.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr size_t kObjects = 1'000'000;
+constexpr size_t kPasses = 5;
+
+struct Counter {
+    size_t hits = 0;
+};
+
+// Where the pages of the objects actually are, as a histogram over the nodes.
+void PrintPlacement(const std::vector<SharedPtr<Counter>>& objects) {
+    std::vector<size_t> per_node(numa::NodeCount());
+    size_t unknown = 0;
+    for (size_t i = 0; i < objects.size(); i += 64) {
+        int node = numa::NodeOf(objects[i].Get());
+        if (node >= 0 && node < numa::NodeCount()) {
+            ++per_node[node];
+        } else {
+            ++unknown;
+        }
+    }
+    std::printf("  placement of sampled objects:");
+    for (size_t node = 0; node < per_node.size(); ++node) {
+        std::printf(" node %zu: %zu", node, per_node[node]);
+    }
+    std::printf(", unknown: %zu\n", unknown);
+}
+
+// Copies and drops every pointer and bumps the object, i.e. touches both the counters and the
+// object from the calling thread.
+template <typename Make>
+void HammerObjects(const std::string& name, Make make) {
+    std::vector<SharedPtr<Counter>> objects;
+    objects.reserve(kObjects);
+    for (size_t i = 0; i < kObjects; ++i) {
+        objects.push_back(make());
+    }
+    MeasureBatchNsPerOp(name.c_str(), kObjects * kPasses, [&objects] {
+        for (size_t pass = 0; pass < kPasses; ++pass) {
+            for (const auto& object : objects) {
+                SharedPtr<Counter> copy = object;
+                ++copy->hits;
+            }
+        }
+    });
+    PrintPlacement(objects);
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("NUMA placement", "[.][bench]") {
+    std::printf("copy + drop + write of %zu objects from a thread on node %d of %d:\n", kObjects,
+                numa::CurrentNode(), numa::NodeCount());
+    HammerObjects("MakeShared, heap", [] { return MakeShared<Counter>(); });
+    for (int node = 0; node < numa::NodeCount(); ++node) {
+        if (!numa::IsNodeAllowed(node)) {
+            continue;
+        }
+        HammerObjects("MakeShared on node " + std::to_string(node),
+                      [node] { return MakeShared<Counter>(NumaPlacement::OnNode(node)); });
+    }
+    HammerObjects("MakeShared local to the thread",
+                  [] { return MakeShared<Counter>(NumaPlacement::Local()); });
+}
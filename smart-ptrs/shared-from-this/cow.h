@@ -0,0 +1,85 @@
+#pragma once
+
+#include "shared.h"
+
+#include <concepts>  // for std::default_initializable
+#include <utility>   // for std::in_place_t / std::as_const / std::move
+
+// Copy-on-write value: copies share one immutable object, and `Write` clones it only if it is
+// shared, so snapshots of a large structure cost one counter increment and an edit of an
+// unshared one costs nothing at all.
+//
+// Copies may live in different threads: each of them reads its own snapshot and writes its own
+// clone. A single `CowPtr` is not synchronized, as a single `SharedPtr` is not. The object is
+// reachable only through `CowPtr`s, so no `WeakPtr` can make a unique object shared while it is
+// modified. A moved-from `CowPtr` may only be assigned to or destroyed.
+template <typename T>
+class CowPtr {
+public:
+    CowPtr()
+        requires std::default_initializable<T>
+        : ptr_(MakeShared<T>()) {
+    }
+
+    template <typename... Args>
+    explicit CowPtr(std::in_place_t, Args&&... args)
+        : ptr_(MakeShared<T>(std::forward<Args>(args)...)) {
+    }
+
+    explicit CowPtr(T value) : ptr_(MakeShared<T>(std::move(value))) {
+    }
+
+    CowPtr(const CowPtr&) = default;
+    CowPtr(CowPtr&&) = default;
+    CowPtr& operator=(const CowPtr&) = default;
+    CowPtr& operator=(CowPtr&&) = default;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Reads: shared
+
+    const T& Read() const {
+        return *ptr_;
+    }
+    const T& operator*() const {
+        return *ptr_;
+    }
+    const T* operator->() const {
+        return ptr_.Get();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Writes: in place when unique
+
+    // The object for modification, cloned first if other copies share it. Do not keep the
+    // reference across a copy of this `CowPtr`: writes through it would show in the copy.
+    T& Write() {
+        if (!ptr_.IsUnique()) {
+            ptr_ = MakeShared<T>(std::as_const(*ptr_));
+        }
+        return *ptr_;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // The number of copies sharing the object.
+    size_t UseCount() const {
+        return ptr_.UseCount();
+    }
+
+    bool IsUnique() const {
+        return ptr_.IsUnique();
+    }
+
+    // Whether both are snapshots of the same object, i.e. equal without comparing the objects.
+    bool IsSameObject(const CowPtr& other) const {
+        return ptr_.Get() == other.ptr_.Get();
+    }
+
+    void Swap(CowPtr& other) {
+        ptr_.Swap(other.ptr_);
+    }
+
+private:
+    SharedPtr<T> ptr_;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "shared.h"
+
+#include <common/huge_page_arena.h>
+
+#include <new>      // for placement new
+#include <utility>  // for std::forward
+
+// `MakeShared` control block living in a `HugePageArena`: the object and both counters share one
+// arena block, which goes back to the arena when the last weak reference dies.
+template <typename T>
+class ControlBlockHugePageImpl : public ControlBlockEmplaceImpl<T> {
+public:
+    template <typename... Args>
+    explicit ControlBlockHugePageImpl(Args&&... args)
+        : ControlBlockEmplaceImpl<T>(std::forward<Args>(args)...) {
+    }
+
+    void ZeroWeak() override {
+        this->~ControlBlockHugePageImpl();
+        HugePageArena::Deallocate(this);
+    }
+};
+
+// `MakeShared<T>(HugePages{arena}, args...)` places the object in `arena`. The resulting
+// `SharedPtr` is an ordinary one: copies, `WeakPtr`s and `SharedFromThis` work as usual.
+template <typename T, typename... Args>
+SharedPtr<T> MakeShared(HugePages place, Args&&... args) {
+    using Block = ControlBlockHugePageImpl<T>;
+    void* memory = place.arena.Allocate(sizeof(Block), alignof(Block));
+    Block* block;
+    try {
+        block = new (memory) Block(std::forward<Args>(args)...);
+    } catch (...) {
+        HugePageArena::Deallocate(memory);
+        throw;
+    }
+    return SharedPtr<T>(block->GetRawPtr(), block);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "shared.h"
+
+#include <unique/mmap.h>
+
+#include <cstddef>    // for std::byte / size_t
+#include <stdexcept>  // for std::out_of_range
+
+// Control block which owns a mapping instead of an object: the region is unmapped when the last
+// strong reference, possibly an aliasing one into the middle of it, goes away.
+class ControlBlockMmapImpl : public ControlBlockBase {
+public:
+    ControlBlockMmapImpl(std::byte* data, size_t length) : data_(data), length_(length) {
+    }
+
+    void ZeroStrong() override {
+        munmap(data_, length_);
+        data_ = nullptr;
+    }
+
+    void ZeroWeak() override {
+        delete this;
+    }
+
+private:
+    std::byte* data_;
+    size_t length_;
+};
+
+// Shared read-mostly view of a mapping. Slices and typed views are aliasing `SharedPtr`s into
+// the region, so any of them keeps the whole mapping alive without copying a byte.
+class SharedMappedBuffer {
+public:
+    SharedMappedBuffer() = default;
+
+    // Takes over the mapping of `mapping`.
+    explicit SharedMappedBuffer(MappedBuffer mapping) : size_(mapping.GetDeleter().Length()) {
+        if (mapping) {
+            auto* block = new ControlBlockMmapImpl(mapping.Get(), size_);
+            data_ = SharedPtr<std::byte>(mapping.Release(), block);
+        }
+    }
+
+    std::byte* Data() const {
+        return data_.Get();
+    }
+    size_t Size() const {
+        return size_;
+    }
+
+    // The `length` bytes starting at `offset`, sharing ownership of the mapping.
+    SharedMappedBuffer Slice(size_t offset, size_t length) const {
+        CheckRange(offset, length);
+        SharedMappedBuffer result;
+        result.data_ = SharedPtr<std::byte>(data_, data_.Get() + offset);
+        result.size_ = length;
+        return result;
+    }
+
+    // A `T` stored in the mapping at `offset`, e.g. a file header.
+    template <typename T>
+    SharedPtr<const T> View(size_t offset = 0) const {
+        CheckRange(offset, sizeof(T));
+        return SharedPtr<const T>(data_, reinterpret_cast<const T*>(data_.Get() + offset));
+    }
+
+    const SharedPtr<std::byte>& GetPtr() const {
+        return data_;
+    }
+
+private:
+    void CheckRange(size_t offset, size_t length) const {
+        if (offset > size_ || length > size_ - offset) {
+            throw std::out_of_range("SharedMappedBuffer: range is outside of the mapping");
+        }
+    }
+
+    SharedPtr<std::byte> data_;
+    size_t size_ = 0;
+};
+
+inline SharedMappedBuffer MapFileShared(const char* path, MmapOptions options = {}) {
+    return SharedMappedBuffer(MapFile(path, options));
+}
+
+inline SharedMappedBuffer MapAnonymousShared(size_t length, MmapOptions options = {}) {
+    return SharedMappedBuffer(MapAnonymous(length, options));
+}
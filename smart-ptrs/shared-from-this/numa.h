@@ -0,0 +1,91 @@
+#pragma once
+
+#include "shared.h"
+
+#include <common/huge_page_arena.h>
+#include <common/numa.h>
+
+#include <array>      // for std::array
+#include <atomic>     // for std::atomic
+#include <cstddef>    // for size_t
+#include <new>        // for std::bad_array_new_length
+#include <stdexcept>  // for std::invalid_argument
+
+// Where `MakeShared` should put an object and its counters: on a given NUMA node, or on the node
+// of the thread creating it, which is the right choice when that thread is also its main user.
+struct NumaPlacement {
+    int node;
+
+    static NumaPlacement OnNode(int node) {
+        return {node};
+    }
+
+    static NumaPlacement Local() {
+        return {numa::CurrentNode()};
+    }
+};
+
+// One huge page arena per node, created on first use and never destroyed, so objects may outlive
+// `main`. Nodes the process cannot allocate on (e.g. any node but 0 on a one-node machine) get
+// an unbound arena.
+inline HugePageArena& NumaArena(int node) {
+    if (node < 0 || node >= numa::kMaxNodes) {
+        throw std::invalid_argument("NumaArena: bad node id");
+    }
+    static std::array<std::atomic<HugePageArena*>, numa::kMaxNodes> arenas;
+    HugePageArena* arena = arenas[node].load(std::memory_order_acquire);
+    if (!arena) {
+        auto* fresh = new HugePageArena(node);
+        if (arenas[node].compare_exchange_strong(arena, fresh, std::memory_order_acq_rel)) {
+            arena = fresh;
+        } else {
+            delete fresh;
+        }
+    }
+    return *arena;
+}
+
+// Standard allocator serving memory from `NumaArena(node)`, for `AllocateShared` and containers.
+// Throws `std::invalid_argument` on allocation if the node id is out of range.
+template <typename T>
+class NumaAllocator {
+public:
+    using value_type = T;
+
+    explicit NumaAllocator(NumaPlacement placement) : node_(placement.node) {
+    }
+
+    template <typename U>
+    NumaAllocator(const NumaAllocator<U>& other) : node_(other.Node()) {
+    }
+
+    T* allocate(size_t count) {
+        if (count > size_t(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(NumaArena(node_).Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t) {
+        HugePageArena::Deallocate(ptr);
+    }
+
+    int Node() const {
+        return node_;
+    }
+
+    template <typename U>
+    bool operator==(const NumaAllocator<U>& other) const {
+        return node_ == other.Node();
+    }
+
+private:
+    int node_;
+};
+
+// `MakeShared<T>(NumaPlacement::Local(), args...)`: the object and its counters share one block
+// on the chosen node.
+template <typename T, typename... Args>
+SharedPtr<T> MakeShared(NumaPlacement placement, Args&&... args) {
+    return AllocateShared<T>(NumaAllocator<T>(placement), std::forward<Args>(args)...);
+}
@@ -4,12 +4,21 @@
 #include "weak.h"
 
 #include <cstddef>  // std::nullptr_t
+#include <functional>
 #include <type_traits>
 
 template <typename T>
 class EnableSharedFromThis;
 
-class ESFTBase {};
+// Non-template part of `EnableSharedFromThis`: a non-owning pointer to the control block of the
+// object. The block always outlives the object, so no weak reference has to be kept.
+class ESFTBase {
+protected:
+    mutable ControlBlockBase* block_ = nullptr;
+
+    template <typename U>
+    friend class SharedPtr;
+};
 
 // https://en.cppreference.com/w/cpp/memory/shared_ptr
 template <typename T>
@@ -18,30 +27,24 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
-    SharedPtr() : ptr_(nullptr), block_(nullptr){};
+    constexpr SharedPtr() : ptr_(nullptr), block_(nullptr){};
 
-    SharedPtr(std::nullptr_t) : ptr_(nullptr), block_(nullptr){};
+    constexpr SharedPtr(std::nullptr_t) : ptr_(nullptr), block_(nullptr){};
 
     SharedPtr(T* ptr, ControlBlockBase* block) : ptr_(ptr), block_(block) {
-        if constexpr (std::is_convertible_v<T*, ESFTBase*>) {
-            ptr->weak_this_ = WeakPtr(*this);
-        }
+        SharedFromThisHelper(ptr);
     };
 
     explicit SharedPtr(T* ptr) : ptr_(ptr) {
         ControlBlockBase* a = new ControlBlockPointerImpl<T>(ptr);
         block_ = a;
-        if constexpr (std::is_convertible_v<T*, ESFTBase*>) {
-            ptr->weak_this_ = WeakPtr(*this);
-        }
+        SharedFromThisHelper(ptr);
     };
 
     template <typename U>
     explicit SharedPtr<T>(U* ptr) : ptr_(ptr) {
         block_ = new ControlBlockPointerImpl<U>(ptr);
-        if constexpr (std::is_convertible_v<T*, ESFTBase*>) {
-            ptr->weak_this_ = WeakPtr(*this);
-        }
+        SharedFromThisHelper(ptr);
     };
 
     SharedPtr(const SharedPtr<T>& other) noexcept : ptr_(other.ptr_), block_(other.block_) {
@@ -81,12 +84,9 @@ public:
     // #11 from https://en.cppreference.com/w/cpp/memory/shared_ptr/shared_ptr
 
     explicit SharedPtr(const WeakPtr<T>& other) : ptr_(other.ptr_), block_(other.block_) {
-        if (block_ && !block_->ExistsStrong()) {
+        if (block_ && !block_->IncrementStrongIfNotZero()) {
             throw BadWeakPtr();
         }
-        if (block_) {
-            block_->IncrementStrong();
-        }
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -132,22 +132,18 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Destructor
 
-    ~SharedPtr() {
+    constexpr ~SharedPtr() {
         Reset();
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Modifiers
-    void Reset() {
-        if (block_ && ptr_) {
-            if (block_->GetStrong() == 1) {
-                block_->DecrementStrong();
-                ptr_ = nullptr;
-                block_ = nullptr;
-            } else {
-                block_->DecrementStrong();
-            }
+    constexpr void Reset() {
+        if (block_) {
+            block_->DecrementStrong();
         }
+        ptr_ = nullptr;
+        block_ = nullptr;
     };
 
     void Reset(T* ptr) {
@@ -159,6 +155,7 @@ public:
                 block_->Put();
             }
             ptr_ = ptr;
+            SharedFromThisHelper(ptr);
         }
     };
 
@@ -174,6 +171,7 @@ public:
                     block_->Put();
                 }
                 ptr_ = static_cast<U*>(ptr);
+                SharedFromThisHelper(ptr);
             }
         }
     };
@@ -186,13 +184,13 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Observers
 
-    T* Get() const {
+    constexpr T* Get() const {
         return ptr_;
     };
-    T& operator*() const {
+    constexpr T& operator*() const {
         return *ptr_;
     };
-    T* operator->() const {
+    constexpr T* operator->() const {
         return ptr_;
     };
 
@@ -203,31 +201,88 @@ public:
             return 0;
         }
     };
-    explicit operator bool() const {
+
+    // The only owner, with no `WeakPtr` to the object: unless such pointers are being created
+    // concurrently (they need an owner or a weak reference to start from), the object may be
+    // modified in place. False for empty and immortal pointers.
+    bool IsUnique() const {
+        return block_ && block_->IsUnique();
+    }
+    constexpr explicit operator bool() const {
         return ptr_ != nullptr;
     };
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Owner-based ordering and hashing: pointers sharing a control block are equivalent
+
+    template <typename U>
+    bool OwnerBefore(const SharedPtr<U>& other) const noexcept {
+        return std::less<const ControlBlockBase*>()(block_, other.block_);
+    }
+    template <typename U>
+    bool OwnerBefore(const WeakPtr<U>& other) const noexcept {
+        return std::less<const ControlBlockBase*>()(block_, other.block_);
+    }
+
+    template <typename U>
+    bool OwnerEqual(const SharedPtr<U>& other) const noexcept {
+        return block_ == other.block_;
+    }
+    template <typename U>
+    bool OwnerEqual(const WeakPtr<U>& other) const noexcept {
+        return block_ == other.block_;
+    }
+
+    size_t OwnerHash() const noexcept {
+        return std::hash<const ControlBlockBase*>()(block_);
+    }
+
 private:
+    // Points the `EnableSharedFromThis` base of a newly owned object (if any) at this block.
+    // Resolved at compile time: types without the base pay nothing.
+    template <typename Y>
+    void SharedFromThisHelper(Y* ptr) {
+        if constexpr (std::is_convertible_v<Y*, const ESFTBase*>) {
+            const ESFTBase* base = ptr;
+            if (base && !base->block_) {
+                base->block_ = block_;
+            }
+        }
+    }
+
     T* ptr_;
     ControlBlockBase* block_;
 
     template <typename U>
     friend class SharedPtr;
 
+    template <typename U>
+    friend class EnableSharedFromThis;
+
     template <typename U>
     friend class WeakPtr;
 
     template <typename U, typename... Args>
     friend SharedPtr<U> MakeShared(Args&&... args);
 
+    template <typename U, typename... Args>
+    friend SharedPtr<U> MakeImmortalShared(Args&&... args);
+
     friend class ControlBlockBase;
 };
 
 template <typename T, typename U>
-inline bool operator==(const SharedPtr<T>& left, const SharedPtr<U>& right) {
+constexpr bool operator==(const SharedPtr<T>& left, const SharedPtr<U>& right) {
     return left.Get() == right.Get();
 };
 
+template <typename T>
+struct std::hash<SharedPtr<T>> {
+    size_t operator()(const SharedPtr<T>& ptr) const noexcept {
+        return std::hash<T*>()(ptr.Get());
+    }
+};
+
 // Allocate memory only once
 template <typename T, typename... Args>
 SharedPtr<T> MakeShared(Args&&... args) {
@@ -235,37 +290,96 @@ SharedPtr<T> MakeShared(Args&&... args) {
     return SharedPtr<T>(block->GetRawPtr(), block);
 };
 
+// `MakeShared` with the single block allocated by `alloc`, which is kept in the block to free it.
+template <typename T, typename Alloc, typename... Args>
+SharedPtr<T> AllocateShared(const Alloc& alloc, Args&&... args) {
+    using Block = ControlBlockAllocateImpl<T, Alloc>;
+    typename Block::BlockAllocator block_alloc(alloc);
+    Block* block = std::allocator_traits<typename Block::BlockAllocator>::allocate(block_alloc, 1);
+    try {
+        new (block) Block(block_alloc, std::forward<Args>(args)...);
+    } catch (...) {
+        std::allocator_traits<typename Block::BlockAllocator>::deallocate(block_alloc, block, 1);
+        throw;
+    }
+    return SharedPtr<T>(block->GetRawPtr(), block);
+};
+
+// Like `MakeShared`, but the object is never destroyed and its control block is immortal:
+// copying and destroying the pointers only read it. Meant for singletons shared by all threads.
+template <typename T, typename... Args>
+SharedPtr<T> MakeImmortalShared(Args&&... args) {
+    auto block = new ControlBlockEmplaceImpl<T>(std::forward<Args>(args)...);
+    block->MakeImmortal();
+    return SharedPtr<T>(block->GetRawPtr(), block);
+};
+
+// The object keeps a single pointer to its control block, set by `MakeShared` and by the
+// constructors taking ownership of a raw pointer. `SharedFromThis` is one counter increment.
 template <typename T>
 class EnableSharedFromThis : public ESFTBase {
 public:
     SharedPtr<T> SharedFromThis() {
-        auto e = weak_this_.Lock();
-        return SharedPtr<T>(e);
+        SharedPtr<T> result;
+        result.block_ = LockBlock();
+        result.ptr_ = Self();
+        return result;
     };
     SharedPtr<const T> SharedFromThis() const {
-        auto e = weak_this_.Lock();
-        if (e) {
-            return SharedPtr<const T>(e);
-        } else {
-            throw BadWeakPtr();
-        }
+        SharedPtr<const T> result;
+        result.block_ = LockBlock();
+        result.ptr_ = Self();
+        return result;
     };
 
     WeakPtr<T> WeakFromThis() noexcept {
-        return weak_this_;
+        WeakPtr<T> result;
+        if (block_) {
+            block_->IncrementWeak();
+            result.block_ = block_;
+            result.ptr_ = Self();
+        }
+        return result;
     };
     WeakPtr<const T> WeakFromThis() const noexcept {
-        return weak_this_;
+        WeakPtr<const T> result;
+        if (block_) {
+            block_->IncrementWeak();
+            result.block_ = block_;
+            result.ptr_ = Self();
+        }
+        return result;
     };
 
-    mutable WeakPtr<T> weak_this_;
-
 protected:
     EnableSharedFromThis() = default;
 
-    EnableSharedFromThis(const EnableSharedFromThis&) = default;
+    // A copy is a different object which is not owned by anyone yet.
+    EnableSharedFromThis(const EnableSharedFromThis&) {
+    }
 
-    EnableSharedFromThis& operator=(const EnableSharedFromThis&) = default;
+    EnableSharedFromThis& operator=(const EnableSharedFromThis&) {
+        return *this;
+    }
 
     ~EnableSharedFromThis() = default;
+
+private:
+    ControlBlockBase* LockBlock() const {
+        if (!block_ || !block_->IncrementStrongIfNotZero()) {
+            throw BadWeakPtr();
+        }
+        return block_;
+    }
+
+    T* Self() const {
+        auto* self = const_cast<EnableSharedFromThis*>(this);
+        if constexpr (requires { static_cast<T*>(self); }) {
+            return static_cast<T*>(self);
+        } else {
+            // `EnableSharedFromThis<T>` is a virtual base of `T`: ask the block, which knows
+            // the dynamic type of the object.
+            return static_cast<T*>(block_->GetSharedFromThisObject());
+        }
+    }
 };
\ No newline at end of file
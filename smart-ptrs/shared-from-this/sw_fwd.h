@@ -1,7 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <exception>
+#include <memory>
 #include <cstddef>
+#include <type_traits>
+#include <utility>
 
 class BadWeakPtr : public std::exception {};
 
@@ -11,60 +15,124 @@ class SharedPtr;
 template <typename T>
 class WeakPtr;
 
+template <typename T>
+class EnableSharedFromThis;
+
+// Deduces `T` from the `EnableSharedFromThis<T>` base of the pointee; `void` if there is none.
+template <typename T>
+T* SharedFromThisTarget(EnableSharedFromThis<T>*);
+void* SharedFromThisTarget(...);
+
+template <typename Y>
+using SharedFromThisTargetT =
+    std::remove_pointer_t<decltype(SharedFromThisTarget(std::declval<Y*>()))>;
+
 class ControlBlockBase {
 public:
     virtual void ZeroStrong() = 0;
     virtual void ZeroWeak() = 0;
     virtual ~ControlBlockBase() = default;
 
+    // Counters are atomic, so pointers sharing a block may be copied and destroyed from different
+    // threads. `weak_` holds one extra reference on behalf of all strong owners: the block dies
+    // when the last weak reference goes away, and the object destructor may still create and
+    // drop weak references to itself (e.g. through `WeakFromThis`).
     virtual void IncrementStrong() {
-        ++strong_;
+        if (!IsImmortal()) {
+            strong_.fetch_add(1, std::memory_order_relaxed);
+        }
     };
 
+    // Takes a strong reference only if the object is still alive (`WeakPtr::Lock`).
+    virtual bool IncrementStrongIfNotZero() {
+        int count = strong_.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (count >= kImmortalThreshold) {
+                return true;
+            }
+            if (strong_.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     virtual void DecrementStrong() {
-        --strong_;
-        if (strong_ == 0 && weak_ != 0) {
-            ZeroStrong();
-        } else if (weak_ == 0 && strong_ == 0) {
+        if (IsImmortal()) {
+            return;
+        }
+        if (strong_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             ZeroStrong();
-            ZeroWeak();
+            DecrementWeak();
         }
     };
     virtual void IncrementWeak() {
-        ++weak_;
+        if (!IsImmortal()) {
+            weak_.fetch_add(1, std::memory_order_relaxed);
+        }
     };
     virtual void DecrementWeak() {
-        --weak_;
-        if (weak_ + strong_ == 0) {
+        if (IsImmortal()) {
+            return;
+        }
+        if (weak_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             ZeroWeak();
         }
     };
 
+    // An immortal block is never written to: the object and the block are never destroyed, and
+    // copies of pointers to them do not bounce the block's cache line between cores.
+    // Must be called before the block is shared with other threads.
+    void MakeImmortal() {
+        strong_.store(kImmortal, std::memory_order_relaxed);
+        weak_.store(kImmortal, std::memory_order_relaxed);
+    }
+
+    bool IsImmortal() const {
+        return strong_.load(std::memory_order_relaxed) >= kImmortalThreshold;
+    }
+
+    // One strong owner and no weak reference. The acquire loads pair with the releases in
+    // `DecrementStrong`/`DecrementWeak`, so whatever former owners in other threads did with the
+    // object happens before anything the caller does next.
+    bool IsUnique() const {
+        return strong_.load(std::memory_order_acquire) == 1 &&
+               weak_.load(std::memory_order_acquire) == 1;
+    }
+
     virtual int GetStrong() {
-        return strong_;
+        return strong_.load(std::memory_order_relaxed);
     }
 
     virtual int GetWeak() {
-        return weak_;
+        return weak_.load(std::memory_order_relaxed) - (ExistsStrong() ? 1 : 0);
     }
 
     virtual void Put() {
-        strong_ = 1;
-    }
-
-    virtual void PutWeak() {
-        weak_ = 0;
+        strong_.store(1, std::memory_order_relaxed);
     }
 
     virtual bool ExistsStrong() {
-        return (strong_ > 0);
+        return GetStrong() > 0;
     }
     virtual bool ExistsWeak() {
-        return (weak_ > 0);
+        return GetWeak() > 0;
+    }
+
+    // The owned object converted to the `T*` of its `EnableSharedFromThis<T>` base.
+    // Only used when that base is virtual, so `this` cannot be cast down statically.
+    virtual void* GetSharedFromThisObject() {
+        return nullptr;
     }
 
-    int strong_ = 1;
-    int weak_ = 0;
+    // Counts at or above the threshold are immortal. Blocks are made immortal with a count in
+    // the middle of that range, so nothing in flight can move them out of it.
+    static constexpr int kImmortalThreshold = 1 << 30;
+    static constexpr int kImmortal = 3 << 29;
+
+    std::atomic<int> strong_ = 1;
+    std::atomic<int> weak_ = 1;
 };
 
 template <typename T>
@@ -82,6 +150,14 @@ public:
         delete tmp;
     }
 
+    void* GetSharedFromThisObject() override {
+        if constexpr (std::is_void_v<SharedFromThisTargetT<T>>) {
+            return nullptr;
+        } else {
+            return static_cast<SharedFromThisTargetT<T>*>(ptr_);
+        }
+    }
+
     void ZeroWeak() override {
         delete this;
     }
@@ -107,10 +183,59 @@ public:
         delete this;
     }
 
+    void* GetSharedFromThisObject() override {
+        if constexpr (std::is_void_v<SharedFromThisTargetT<T>>) {
+            return nullptr;
+        } else {
+            return static_cast<SharedFromThisTargetT<T>*>(GetRawPtr());
+        }
+    }
+
+    T* GetRawPtr() {
+        return reinterpret_cast<T*>(&holder_);
+    }
+
+private:
+    alignas(T) unsigned char holder_[sizeof(T)];
+};
+
+// `AllocateShared` control block: like `ControlBlockEmplaceImpl`, but the block is obtained from
+// (and returned to) a copy of the user's allocator, rebound to the block type.
+template <typename T, typename Alloc>
+class ControlBlockAllocateImpl : public ControlBlockBase {
+public:
+    using BlockAllocator =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<ControlBlockAllocateImpl>;
+
+    template <typename... Args>
+    explicit ControlBlockAllocateImpl(const BlockAllocator& alloc, Args&&... args)
+        : alloc_(alloc) {
+        new (&holder_) T(std::forward<Args>(args)...);
+    }
+
+    void ZeroStrong() override {
+        GetRawPtr()->~T();
+    }
+
+    void ZeroWeak() override {
+        BlockAllocator alloc = alloc_;
+        this->~ControlBlockAllocateImpl();
+        std::allocator_traits<BlockAllocator>::deallocate(alloc, this, 1);
+    }
+
+    void* GetSharedFromThisObject() override {
+        if constexpr (std::is_void_v<SharedFromThisTargetT<T>>) {
+            return nullptr;
+        } else {
+            return static_cast<SharedFromThisTargetT<T>*>(GetRawPtr());
+        }
+    }
+
     T* GetRawPtr() {
         return reinterpret_cast<T*>(&holder_);
     }
 
 private:
+    BlockAllocator alloc_;
     alignas(T) unsigned char holder_[sizeof(T)];
 };
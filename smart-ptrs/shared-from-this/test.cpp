@@ -89,3 +89,82 @@ TEST_CASE("WeakFromThis") {
     REQUIRE(!weak.Expired());
     REQUIRE(weak.Lock().Get() == ptr);
 }
+
+struct SelfInDestructor : EnableSharedFromThis<SelfInDestructor> {
+    ~SelfInDestructor() {
+        auto weak = WeakFromThis();
+        expired_in_destructor = weak.Expired();
+    }
+
+    static inline bool expired_in_destructor = false;
+};
+
+TEST_CASE("SharedFromThis wiring") {
+    SECTION("One word per object") {
+        static_assert(sizeof(EnableSharedFromThis<T>) == sizeof(void*));
+    }
+
+    SECTION("Not owned") {
+        T object;
+        REQUIRE_THROWS_AS(object.SharedFromThis(), BadWeakPtr);
+        REQUIRE(object.WeakFromThis().Expired());
+    }
+
+    SECTION("Copy is not owned") {
+        auto owned = MakeShared<T>();
+        T copy = *owned;
+        REQUIRE_THROWS_AS(copy.SharedFromThis(), BadWeakPtr);
+        copy = *owned;
+        REQUIRE_THROWS_AS(copy.SharedFromThis(), BadWeakPtr);
+    }
+
+    SECTION("MakeShared") {
+        auto p = MakeShared<Z>();
+        SharedPtr<T> self = p->SharedFromThis();
+        REQUIRE(self == p);
+        REQUIRE(p.UseCount() == 2);
+    }
+
+    SECTION("Reset") {
+        SharedPtr<T> p;
+        p.Reset(new T);
+        REQUIRE(p->SharedFromThis() == p);
+    }
+
+    SECTION("Destructor") {
+        SelfInDestructor::expired_in_destructor = false;
+        MakeShared<SelfInDestructor>();
+        REQUIRE(SelfInDestructor::expired_in_destructor);
+    }
+}
+
+TEST_CASE("MakeImmortalShared") {
+    // Immortal objects are never freed; keep them reachable for leak checkers.
+    static SharedPtr<int>& immortal = *new SharedPtr<int>(MakeImmortalShared<int>(7));
+    size_t count = immortal.UseCount();
+
+    SECTION("Copies do not count") {
+        {
+            SharedPtr<int> copy = immortal;
+            SharedPtr<int> other;
+            other = copy;
+        }
+        REQUIRE(immortal.UseCount() == count);
+        REQUIRE(*immortal == 7);
+    }
+
+    SECTION("Weak references") {
+        WeakPtr<int> weak = immortal;
+        REQUIRE(!weak.Expired());
+        REQUIRE(*weak.Lock() == 7);
+        weak.Reset();
+        REQUIRE(immortal.UseCount() == count);
+    }
+
+    SECTION("Shared from this") {
+        static SharedPtr<T>& singleton = *new SharedPtr<T>(MakeImmortalShared<T>());
+        SharedPtr<T> self = singleton->SharedFromThis();
+        REQUIRE(self == singleton);
+        REQUIRE(singleton.UseCount() == count);
+    }
+}
@@ -0,0 +1,146 @@
+#include "cow.h"
+
+#include <catch.hpp>
+
+#include "allocations_checker.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+int copies = 0;
+
+struct Document {
+    Document() = default;
+    explicit Document(std::vector<int> lines) : lines(std::move(lines)) {
+    }
+    Document(const Document& other) : lines(other.lines) {
+        ++copies;
+    }
+
+    std::vector<int> lines;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("CowPtr shares reads") {
+    CowPtr<Document> doc(std::in_place, std::vector<int>{1, 2, 3});
+    REQUIRE(doc.IsUnique());
+
+    copies = 0;
+    EXPECT_ZERO_ALLOCATIONS(CowPtr<Document> snapshot(doc));
+    CowPtr<Document> snapshot = doc;
+    REQUIRE(snapshot.IsSameObject(doc));
+    REQUIRE(doc.UseCount() == 2);
+    REQUIRE(!doc.IsUnique());
+    REQUIRE(snapshot->lines == std::vector<int>{1, 2, 3});
+    REQUIRE((*doc).lines.size() == 3);
+    REQUIRE(copies == 0);
+}
+
+TEST_CASE("CowPtr writes in place when unique") {
+    CowPtr<Document> doc(Document(std::vector<int>{1, 2, 3}));
+    copies = 0;
+    const Document* before = &doc.Read();
+    EXPECT_ZERO_ALLOCATIONS(doc.Write().lines[0] = 10);
+    REQUIRE(&doc.Read() == before);
+    REQUIRE(doc->lines[0] == 10);
+
+    // The snapshot is gone: the next write is in place again.
+    { CowPtr<Document> snapshot = doc; }
+    EXPECT_ZERO_ALLOCATIONS(doc.Write().lines[1] = 20);
+    REQUIRE(copies == 0);
+}
+
+TEST_CASE("CowPtr clones shared objects on write") {
+    CowPtr<Document> doc(std::in_place, std::vector<int>{1, 2, 3});
+    CowPtr<Document> snapshot = doc;
+
+    copies = 0;
+    doc.Write().lines[0] = 10;
+    REQUIRE(copies == 1);
+    REQUIRE(!doc.IsSameObject(snapshot));
+    REQUIRE(doc.IsUnique());
+    REQUIRE(snapshot.IsUnique());
+    REQUIRE(doc->lines == std::vector<int>{10, 2, 3});
+    REQUIRE(snapshot->lines == std::vector<int>{1, 2, 3});
+
+    doc.Write().lines[1] = 20;
+    REQUIRE(copies == 1);
+}
+
+TEST_CASE("CowPtr assignment and swap") {
+    CowPtr<std::string> first(std::string("first"));
+    CowPtr<std::string> second(std::string("second"));
+    first.Swap(second);
+    REQUIRE(*first == "second");
+    REQUIRE(*second == "first");
+
+    second = first;
+    REQUIRE(second.IsSameObject(first));
+    second.Write() += "!";
+    REQUIRE(*first == "second");
+    REQUIRE(*second == "second!");
+
+    CowPtr<std::string> empty;
+    REQUIRE(empty->empty());
+}
+
+TEST_CASE("CowPtr copies written from many threads") {
+    constexpr int kThreads = 8;
+    constexpr int kWrites = 1024;
+    CowPtr<Document> original(std::in_place, std::vector<int>(16, 0));
+
+    std::vector<CowPtr<Document>> results(kThreads, original);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            CowPtr<Document>& mine = results[t];
+            for (int i = 0; i < kWrites; ++i) {
+                mine.Write().lines[i % 16] += t;
+                // Snapshots dropped in this thread keep `mine` unique.
+                CowPtr<Document> snapshot = mine;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(original->lines == std::vector<int>(16, 0));
+    REQUIRE(original.IsUnique());
+    for (int t = 0; t < kThreads; ++t) {
+        REQUIRE(results[t].IsUnique());
+        for (int line : results[t]->lines) {
+            REQUIRE(line == t * kWrites / 16);
+        }
+    }
+}
+
+TEST_CASE("SharedPtr::IsUnique") {
+    SharedPtr<int> empty;
+    REQUIRE(!empty.IsUnique());
+
+    auto ptr = MakeShared<int>(1);
+    REQUIRE(ptr.IsUnique());
+    {
+        WeakPtr<int> weak(ptr);
+        REQUIRE(ptr.UseCount() == 1);
+        REQUIRE(!ptr.IsUnique());
+    }
+    REQUIRE(ptr.IsUnique());
+    {
+        auto copy = ptr;
+        REQUIRE(!ptr.IsUnique());
+    }
+    REQUIRE(ptr.IsUnique());
+
+    static SharedPtr<int>& immortal = *new SharedPtr<int>(MakeImmortalShared<int>(2));
+    REQUIRE(!immortal.IsUnique());
+}
@@ -0,0 +1,101 @@
+#include "shared.h"
+#include "weak.h"
+
+#include <catch.hpp>
+
+#include <common/pointer_hash.h>
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Pair {
+    int first = 1;
+    int second = 2;
+};
+
+}  // namespace
+
+TEST_CASE("Owner-based comparison") {
+    auto pair = MakeShared<Pair>();
+    SharedPtr<int> first(pair, &pair->first);
+    SharedPtr<int> second(pair, &pair->second);
+    WeakPtr<Pair> weak(pair);
+    auto other = MakeShared<Pair>();
+
+    SECTION("Aliasing pointers share the owner") {
+        REQUIRE(!(first == second));
+        REQUIRE(first.OwnerEqual(second));
+        REQUIRE(first.OwnerHash() == second.OwnerHash());
+        REQUIRE(!first.OwnerBefore(second));
+        REQUIRE(!second.OwnerBefore(first));
+        REQUIRE(!first.OwnerEqual(other));
+        REQUIRE(first.OwnerBefore(other) != other.OwnerBefore(first));
+    }
+
+    SECTION("WeakPtr keeps the owner after expiration") {
+        REQUIRE(weak.OwnerEqual(pair));
+        REQUIRE(pair.OwnerEqual(weak));
+        auto hash = weak.OwnerHash();
+        pair.Reset();
+        first.Reset();
+        second.Reset();
+        REQUIRE(weak.Expired());
+        REQUIRE(weak.OwnerHash() == hash);
+    }
+
+    SECTION("Empty pointers") {
+        SharedPtr<int> empty;
+        WeakPtr<int> empty_weak;
+        REQUIRE(empty.OwnerEqual(empty_weak));
+        REQUIRE(!empty.OwnerEqual(first));
+    }
+
+    SECTION("Functors") {
+        std::map<WeakPtr<Pair>, int, OwnerLess> by_owner;
+        by_owner[weak] = 1;
+        by_owner[WeakPtr<Pair>(other)] = 2;
+        REQUIRE(by_owner.size() == 2);
+        REQUIRE(by_owner.find(pair) != by_owner.end());
+        REQUIRE(by_owner.find(pair)->second == 1);
+
+        std::unordered_map<WeakPtr<Pair>, int, OwnerHash, OwnerEqual> hashed;
+        hashed[weak] = 1;
+        REQUIRE(hashed.find(pair) != hashed.end());
+        REQUIRE(hashed.find(other) == hashed.end());
+    }
+}
+
+TEST_CASE("Pointer hashing") {
+    SECTION("std::hash") {
+        auto p = MakeShared<int>(1);
+        auto q = p;
+        REQUIRE(std::hash<SharedPtr<int>>()(p) == std::hash<SharedPtr<int>>()(q));
+        REQUIRE(std::hash<SharedPtr<int>>()(p) == std::hash<int*>()(p.Get()));
+
+        std::unordered_set<SharedPtr<int>> set{p};
+        REQUIRE(set.count(q) == 1);
+    }
+
+    SECTION("Heterogeneous lookup by raw pointer") {
+        std::unordered_set<SharedPtr<Pair>, PointerHash, PointerEqual> set;
+        auto a = MakeShared<Pair>();
+        auto b = MakeShared<Pair>();
+        set.insert(a);
+        set.insert(b);
+
+        Pair* raw = a.Get();
+        auto it = set.find(raw);
+        REQUIRE(it != set.end());
+        REQUIRE(it->Get() == raw);
+        REQUIRE(a.UseCount() == 2);
+
+        Pair unknown;
+        REQUIRE(set.find(&unknown) == set.end());
+        REQUIRE(set.contains(b.Get()));
+    }
+}
@@ -0,0 +1,53 @@
+#include "mmap_shared.h"
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Header {
+    uint32_t magic;
+    uint32_t count;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("SharedMappedBuffer") {
+    constexpr size_t kLength = 1 << 16;
+    SharedMappedBuffer buffer = MapAnonymousShared(kLength);
+    REQUIRE(buffer.Size() == kLength);
+    Header header{0xfeed, 3};
+    std::memcpy(buffer.Data(), &header, sizeof(header));
+
+    SECTION("Views keep the mapping alive") {
+        SharedPtr<const Header> view = buffer.View<Header>();
+        SharedMappedBuffer tail = buffer.Slice(kLength - 16, 16);
+        std::byte* data = buffer.Data();
+        buffer = SharedMappedBuffer();
+
+        REQUIRE(view->magic == 0xfeed);
+        REQUIRE(view->count == 3);
+        REQUIRE(tail.Data() == data + kLength - 16);
+        tail.Data()[15] = std::byte{7};
+        REQUIRE(view.UseCount() == 2);
+    }
+
+    SECTION("Bounds") {
+        REQUIRE_THROWS_AS(buffer.Slice(kLength - 1, 2), std::out_of_range);
+        REQUIRE_THROWS_AS(buffer.View<Header>(kLength - 4), std::out_of_range);
+        REQUIRE(buffer.Slice(kLength, 0).Size() == 0);
+    }
+
+    SECTION("Empty") {
+        SharedMappedBuffer empty = MapAnonymousShared(0);
+        REQUIRE(!empty.GetPtr());
+        REQUIRE(empty.Size() == 0);
+    }
+}
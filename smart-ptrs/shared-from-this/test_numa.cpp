@@ -0,0 +1,135 @@
+#include "numa.h"
+#include "weak.h"
+
+#include <catch.hpp>
+
+#include <common/my_int.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct AllocatorStats {
+    size_t allocated = 0;
+    size_t deallocated = 0;
+};
+
+template <typename T>
+class CountingAllocator {
+public:
+    using value_type = T;
+
+    explicit CountingAllocator(AllocatorStats* stats) : stats_(stats) {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) : stats_(other.Stats()) {
+    }
+
+    T* allocate(size_t count) {
+        ++stats_->allocated;
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* ptr, size_t count) {
+        ++stats_->deallocated;
+        std::allocator<T>().deallocate(ptr, count);
+    }
+
+    AllocatorStats* Stats() const {
+        return stats_;
+    }
+
+private:
+    AllocatorStats* stats_;
+};
+
+struct Self : EnableSharedFromThis<Self> {
+    int value = 0;
+};
+
+struct Throwing {
+    Throwing() {
+        throw std::runtime_error("constructor");
+    }
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("AllocateShared") {
+    AllocatorStats stats;
+    CountingAllocator<MyInt> alloc(&stats);
+
+    SECTION("One block, freed after the last weak reference") {
+        WeakPtr<MyInt> weak;
+        {
+            SharedPtr<MyInt> ptr = AllocateShared<MyInt>(alloc, 42);
+            REQUIRE(*ptr == 42);
+            REQUIRE(stats.allocated == 1);
+            weak = ptr;
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+        REQUIRE(weak.Expired());
+        REQUIRE(stats.deallocated == 0);
+        weak.Reset();
+        REQUIRE(stats.deallocated == 1);
+    }
+
+    SECTION("SharedFromThis") {
+        auto ptr = AllocateShared<Self>(CountingAllocator<Self>(&stats));
+        REQUIRE(ptr->SharedFromThis() == ptr);
+    }
+
+    SECTION("Constructor throws") {
+        REQUIRE_THROWS_AS(AllocateShared<Throwing>(CountingAllocator<Throwing>(&stats)),
+                          std::runtime_error);
+        REQUIRE(stats.allocated == 1);
+        REQUIRE(stats.deallocated == 1);
+    }
+}
+
+TEST_CASE("NUMA placement") {
+    REQUIRE(numa::NodeCount() >= 1);
+    REQUIRE(numa::IsNodeAllowed(numa::NodeCount() - 1));
+    REQUIRE(numa::CurrentNode() >= 0);
+
+    SECTION("Objects land on the requested node") {
+        for (int node = 0; node < numa::NodeCount(); ++node) {
+            if (!numa::IsNodeAllowed(node)) {
+                continue;
+            }
+            std::vector<SharedPtr<MyInt>> objects;
+            for (int i = 0; i < 100; ++i) {
+                objects.push_back(MakeShared<MyInt>(NumaPlacement::OnNode(node), i));
+            }
+            for (int i = 0; i < 100; ++i) {
+                REQUIRE(*objects[i] == i);
+            }
+            REQUIRE(numa::NodeOf(objects.front().Get()) == node);
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+
+    SECTION("Local to the calling thread") {
+        auto ptr = MakeShared<Self>(NumaPlacement::Local());
+        ptr->value = 1;
+        // The thread may migrate and the preferred node may run out of memory, so the page can
+        // end up anywhere this process is allowed to allocate.
+        REQUIRE(numa::IsNodeAllowed(numa::NodeOf(ptr.Get())));
+        WeakPtr<Self> weak = ptr->WeakFromThis();
+        REQUIRE(weak.Lock() == ptr);
+    }
+
+    SECTION("Nodes missing on this machine still work") {
+        int missing = numa::NodeCount();
+        auto ptr = MakeShared<MyInt>(NumaPlacement::OnNode(missing), 5);
+        REQUIRE(*ptr == 5);
+        REQUIRE_THROWS_AS(MakeShared<MyInt>(NumaPlacement::OnNode(-1), 5), std::invalid_argument);
+    }
+}
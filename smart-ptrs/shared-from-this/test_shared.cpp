@@ -8,6 +8,15 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Empty pointers are constant-initialized: no dynamic initializer runs for these globals.
+constinit SharedPtr<int> global_shared;
+constinit SharedPtr<int> global_null_shared = nullptr;
+constinit WeakPtr<int> global_weak;
+
+static_assert(!SharedPtr<int>());
+static_assert(SharedPtr<int>(nullptr).Get() == nullptr);
+static_assert(SharedPtr<int>() == SharedPtr<int>(nullptr));
+
 TEST_CASE("Empty") {
     SECTION("Empty state") {
         SharedPtr<int> a, b;
@@ -25,6 +34,19 @@ TEST_CASE("Empty") {
         EXPECT_ZERO_ALLOCATIONS(SharedPtr<int>());
         EXPECT_ZERO_ALLOCATIONS(SharedPtr<int>(nullptr));
     }
+
+    SECTION("Constant-initialized globals") {
+        REQUIRE(!global_shared);
+        REQUIRE(!global_null_shared);
+        REQUIRE(global_weak.Expired());
+
+        global_shared = MakeShared<int>(1);
+        global_weak = global_shared;
+        REQUIRE(global_weak.Lock().Get() == global_shared.Get());
+        global_shared.Reset();
+        REQUIRE(global_weak.Expired());
+        global_weak.Reset();
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,113 @@
+#include "weak_cache.h"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("WeakCache") {
+    WeakCache<int, std::string> cache;
+
+    SECTION("Hit while held, miss after release") {
+        auto value = MakeShared<std::string>("decoded");
+        cache.Put(1, value);
+        REQUIRE(cache.Get(1) == value);
+        REQUIRE(value.UseCount() == 1);
+
+        value.Reset();
+        REQUIRE(!cache.Get(1));
+        REQUIRE(!cache.Get(2));
+
+        auto stats = cache.GetStats();
+        REQUIRE(stats.hits == 1);
+        REQUIRE(stats.misses == 2);
+    }
+
+    SECTION("GetOrCreate") {
+        int calls = 0;
+        auto factory = [&] {
+            ++calls;
+            return MakeShared<std::string>("value");
+        };
+        auto first = cache.GetOrCreate(7, factory);
+        auto second = cache.GetOrCreate(7, factory);
+        REQUIRE(first == second);
+        REQUIRE(calls == 1);
+
+        first.Reset();
+        second.Reset();
+        auto third = cache.GetOrCreate(7, factory);
+        REQUIRE(calls == 2);
+        REQUIRE(*third == "value");
+        REQUIRE(cache.GetStats().created == 2);
+    }
+
+    SECTION("Factory throws") {
+        REQUIRE_THROWS(cache.GetOrCreate(3, []() -> SharedPtr<std::string> { throw 42; }));
+        auto value = cache.GetOrCreate(3, [] { return MakeShared<std::string>("ok"); });
+        REQUIRE(*value == "ok");
+        REQUIRE(cache.Size() == 1);
+    }
+
+    SECTION("Incremental purge keeps size bounded") {
+        SharedPtr<std::string> alive = MakeShared<std::string>("alive");
+        cache.Put(-1, alive);
+        for (int i = 0; i < 10000; ++i) {
+            cache.Put(i, MakeShared<std::string>("temporary"));
+        }
+        // Each operation removes up to two expired entries of its shard.
+        REQUIRE(cache.Size() < 200);
+        REQUIRE(cache.GetStats().purged > 9000);
+        REQUIRE(cache.Get(-1) == alive);
+
+        cache.Purge();
+        REQUIRE(cache.Size() == 1);
+    }
+
+    SECTION("Erase") {
+        auto value = MakeShared<std::string>("value");
+        cache.Put(5, value);
+        cache.Erase(5);
+        REQUIRE(!cache.Get(5));
+        REQUIRE(cache.Size() == 0);
+    }
+}
+
+TEST_CASE("WeakCache concurrent GetOrCreate") {
+    WeakCache<int, int> cache;
+    std::atomic<int> calls = 0;
+    constexpr int kThreads = 8;
+    constexpr int kKeys = 64;
+
+    std::vector<SharedPtr<int>> held(kThreads * kKeys);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int key = 0; key < kKeys; ++key) {
+                held[t * kKeys + key] = cache.GetOrCreate(key, [&] {
+                    ++calls;
+                    std::this_thread::yield();
+                    return MakeShared<int>(key);
+                });
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(calls == kKeys);
+    for (int t = 0; t < kThreads; ++t) {
+        for (int key = 0; key < kKeys; ++key) {
+            REQUIRE(held[t * kKeys + key] == held[key]);
+            REQUIRE(*held[t * kKeys + key] == key);
+        }
+    }
+    auto stats = cache.GetStats();
+    REQUIRE(stats.hits + stats.misses == kThreads * kKeys);
+    REQUIRE(stats.created == kKeys);
+}
@@ -2,10 +2,12 @@
 
 #include "sw_fwd.h"  // Forward declaration
 
+#include <functional>
+
 template <typename T>
 class WeakPtr {
 public:
-    WeakPtr() : ptr_(nullptr), block_(nullptr){};
+    constexpr WeakPtr() : ptr_(nullptr), block_(nullptr){};
 
     WeakPtr(const WeakPtr& other) : ptr_(other.ptr_), block_(other.block_) {
         if (block_) {
@@ -38,7 +40,7 @@ public:
         }
     }
 
-    ~WeakPtr() {
+    constexpr ~WeakPtr() {
         //        if (block_) {
         //            if (block_->GetWeak() == 1) {
         //
@@ -86,7 +88,7 @@ public:
         return *this;
     }
 
-    void Reset() {
+    constexpr void Reset() {
         if (block_) {
             block_->DecrementWeak();
             block_ = nullptr;
@@ -111,11 +113,34 @@ public:
     }
 
     SharedPtr<T> Lock() const {
-        if (Expired()) {
-            return SharedPtr<T>();
-        } else {
-            return SharedPtr<T>(WeakPtr<T>(*this));
+        SharedPtr<T> result;
+        if (block_ && block_->IncrementStrongIfNotZero()) {
+            result.ptr_ = ptr_;
+            result.block_ = block_;
         }
+        return result;
+    }
+
+    template <typename U>
+    bool OwnerBefore(const WeakPtr<U>& other) const noexcept {
+        return std::less<const ControlBlockBase*>()(block_, other.block_);
+    }
+    template <typename U>
+    bool OwnerBefore(const SharedPtr<U>& other) const noexcept {
+        return std::less<const ControlBlockBase*>()(block_, other.block_);
+    }
+
+    template <typename U>
+    bool OwnerEqual(const WeakPtr<U>& other) const noexcept {
+        return block_ == other.block_;
+    }
+    template <typename U>
+    bool OwnerEqual(const SharedPtr<U>& other) const noexcept {
+        return block_ == other.block_;
+    }
+
+    size_t OwnerHash() const noexcept {
+        return std::hash<const ControlBlockBase*>()(block_);
     }
 
 private:
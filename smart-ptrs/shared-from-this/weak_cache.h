@@ -0,0 +1,223 @@
+#pragma once
+
+#include "shared.h"
+#include "weak.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Cache of objects which live only while somebody outside holds them.
+//
+// Values are stored as `WeakPtr<V>`; a hit is a successful `Lock()`. Keys are split between
+// `NumShards` independently locked shards. Every operation also checks a couple of entries of
+// its shard and drops the expired ones, so dead entries never pile up (amortized O(1) purge).
+template <typename K, typename V, typename Hash = std::hash<K>, size_t NumShards = 16>
+class WeakCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t created = 0;
+        size_t purged = 0;
+    };
+
+    // Returns the cached value or an empty pointer.
+    SharedPtr<V> Get(const K& key) {
+        Shard& shard = GetShard(key);
+        std::lock_guard lock(shard.mutex);
+        SharedPtr<V> result = shard.Find(key);
+        ++(result ? shard.stats.hits : shard.stats.misses);
+        shard.PurgeSome();
+        return result;
+    }
+
+    void Put(const K& key, const SharedPtr<V>& value) {
+        Shard& shard = GetShard(key);
+        std::lock_guard lock(shard.mutex);
+        shard.Store(key, value);
+        shard.PurgeSome();
+    }
+
+    // Returns the cached value or stores `factory()`. Concurrent calls for the same key wait for
+    // the first one, so the value is built once; if the factory throws, a waiter retries.
+    template <typename Factory>
+    SharedPtr<V> GetOrCreate(const K& key, Factory&& factory) {
+        Shard& shard = GetShard(key);
+        std::unique_lock lock(shard.mutex);
+        while (true) {
+            auto it = shard.index.find(key);
+            if (it == shard.index.end()) {
+                break;
+            }
+            Slot& slot = shard.slots[it->second];
+            if (!slot.pending) {
+                if (SharedPtr<V> result = slot.value.Lock()) {
+                    ++shard.stats.hits;
+                    return result;
+                }
+                break;
+            }
+            shard.creation_done.wait(lock);
+        }
+
+        ++shard.stats.misses;
+        shard.MarkPending(key);
+        lock.unlock();
+
+        SharedPtr<V> result;
+        try {
+            result = factory();
+        } catch (...) {
+            lock.lock();
+            shard.Erase(key);
+            shard.creation_done.notify_all();
+            throw;
+        }
+
+        lock.lock();
+        ++shard.stats.created;
+        shard.Store(key, result);
+        shard.PurgeSome();
+        shard.creation_done.notify_all();
+        return result;
+    }
+
+    void Erase(const K& key) {
+        Shard& shard = GetShard(key);
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end() && !shard.slots[it->second].pending) {
+            shard.Erase(key);
+        }
+    }
+
+    // Drops every expired entry at once.
+    void Purge() {
+        for (Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            for (size_t i = shard.slots.size(); i-- > 0;) {
+                shard.PurgeAt(i);
+            }
+        }
+    }
+
+    // The number of stored entries, including expired ones not yet purged.
+    size_t Size() const {
+        size_t result = 0;
+        for (const Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            result += shard.slots.size();
+        }
+        return result;
+    }
+
+    Stats GetStats() const {
+        Stats result;
+        for (const Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            result.hits += shard.stats.hits;
+            result.misses += shard.stats.misses;
+            result.created += shard.stats.created;
+            result.purged += shard.stats.purged;
+        }
+        return result;
+    }
+
+private:
+    // Entries examined by the incremental purge on every operation. Any value above one keeps
+    // the number of expired entries bounded by the number of live ones.
+    static constexpr size_t kPurgeSteps = 2;
+
+    struct Slot {
+        K key;
+        WeakPtr<V> value;
+        bool pending = false;
+    };
+
+    // Entries live in a dense vector indexed by a hash map, so the purge cursor survives
+    // insertions and an expired entry is removed by swapping with the last one.
+    struct Shard {
+        mutable std::mutex mutex;
+        std::condition_variable creation_done;
+        std::unordered_map<K, size_t, Hash> index;
+        std::vector<Slot> slots;
+        size_t purge_cursor = 0;
+        Stats stats;
+
+        SharedPtr<V> Find(const K& key) {
+            auto it = index.find(key);
+            if (it == index.end()) {
+                return SharedPtr<V>();
+            }
+            return slots[it->second].value.Lock();
+        }
+
+        void Store(const K& key, const SharedPtr<V>& value) {
+            auto [it, inserted] = index.try_emplace(key, slots.size());
+            if (inserted) {
+                slots.push_back(Slot{key, WeakPtr<V>(value), false});
+            } else {
+                Slot& slot = slots[it->second];
+                slot.value = WeakPtr<V>(value);
+                slot.pending = false;
+            }
+        }
+
+        void MarkPending(const K& key) {
+            auto [it, inserted] = index.try_emplace(key, slots.size());
+            if (inserted) {
+                slots.push_back(Slot{key, WeakPtr<V>(), true});
+            } else {
+                slots[it->second].pending = true;
+            }
+        }
+
+        void Erase(const K& key) {
+            auto it = index.find(key);
+            if (it != index.end()) {
+                RemoveAt(it->second);
+            }
+        }
+
+        void PurgeSome() {
+            for (size_t step = 0; step < kPurgeSteps && !slots.empty(); ++step) {
+                if (purge_cursor >= slots.size()) {
+                    purge_cursor = 0;
+                }
+                if (!PurgeAt(purge_cursor)) {
+                    ++purge_cursor;
+                }
+            }
+        }
+
+        bool PurgeAt(size_t position) {
+            const Slot& slot = slots[position];
+            if (slot.pending || !slot.value.Expired()) {
+                return false;
+            }
+            ++stats.purged;
+            RemoveAt(position);
+            return true;
+        }
+
+        void RemoveAt(size_t position) {
+            index.erase(slots[position].key);
+            if (position + 1 != slots.size()) {
+                slots[position] = slots.back();
+                index[slots[position].key] = position;
+            }
+            slots.pop_back();
+        }
+    };
+
+    Shard& GetShard(const K& key) {
+        return shards_[Hash()(key) % NumShards];
+    }
+
+    std::array<Shard, NumShards> shards_;
+};
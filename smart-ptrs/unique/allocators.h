@@ -0,0 +1,323 @@
+#pragma once
+
+#include "unique.h"
+
+#include <cstddef>      // for size_t / std::max_align_t
+#include <memory>       // for std::align
+#include <new>          // for std::bad_alloc / std::bad_array_new_length / std::align_val_t
+#include <type_traits>  // for std::is_trivially_destructible_v
+#include <utility>      // for std::forward / std::exchange
+#include <vector>       // for std::vector
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory sources
+
+// Hands out blocks of one size from chunks of `blocks_per_chunk`. Free blocks form an intrusive
+// list, so both `Allocate` and `Deallocate` are O(1) and only a new chunk calls `operator new`.
+class FixedBlockPool {
+public:
+    explicit FixedBlockPool(size_t block_size, size_t block_align = alignof(std::max_align_t),
+                            size_t blocks_per_chunk = 64)
+        : block_align_(block_align < alignof(void*) ? alignof(void*) : block_align),
+          block_size_(RoundUp(block_size < sizeof(void*) ? sizeof(void*) : block_size,
+                              block_align_)),
+          blocks_per_chunk_(blocks_per_chunk) {
+    }
+
+    FixedBlockPool(const FixedBlockPool&) = delete;
+    FixedBlockPool& operator=(const FixedBlockPool&) = delete;
+
+    ~FixedBlockPool() {
+        for (void* chunk : chunks_) {
+            ::operator delete(chunk, std::align_val_t(block_align_));
+        }
+    }
+
+    void* Allocate() {
+        if (!free_list_) {
+            AddChunk();
+        }
+        return std::exchange(free_list_, free_list_->next);
+    }
+
+    void Deallocate(void* block) noexcept {
+        free_list_ = new (block) FreeBlock{free_list_};
+    }
+
+    size_t BlockSize() const {
+        return block_size_;
+    }
+    size_t BlockAlign() const {
+        return block_align_;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static size_t RoundUp(size_t size, size_t align) {
+        return (size + align - 1) / align * align;
+    }
+
+    void AddChunk() {
+        auto* chunk = static_cast<char*>(
+            ::operator new(block_size_ * blocks_per_chunk_, std::align_val_t(block_align_)));
+        chunks_.push_back(chunk);
+        for (size_t i = blocks_per_chunk_; i-- > 0;) {
+            Deallocate(chunk + i * block_size_);
+        }
+    }
+
+    size_t block_align_;
+    size_t block_size_;
+    size_t blocks_per_chunk_;
+    FreeBlock* free_list_ = nullptr;
+    std::vector<void*> chunks_;
+};
+
+// Bump allocator: `Allocate` moves a pointer through the current chunk and nothing is freed
+// before `Reset`, which releases everything at once.
+class Arena {
+public:
+    explicit Arena(size_t chunk_size = 4096) : chunk_size_(chunk_size) {
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        Reset();
+    }
+
+    void* Allocate(size_t size, size_t align) {
+        void* result = std::align(align, size, current_, space_);
+        if (!result) {
+            if (size > size_t(-1) - align) {
+                throw std::bad_alloc();
+            }
+            size_t chunk_size = size + align > chunk_size_ ? size + align : chunk_size_;
+            current_ = ::operator new(chunk_size);
+            space_ = chunk_size;
+            chunks_.push_back(current_);
+            result = std::align(align, size, current_, space_);
+        }
+        current_ = static_cast<char*>(current_) + size;
+        space_ -= size;
+        return result;
+    }
+
+    // Frees every allocation. Objects still placed in the arena must be dead by now.
+    void Reset() {
+        for (void* chunk : chunks_) {
+            ::operator delete(chunk);
+        }
+        chunks_.clear();
+        current_ = nullptr;
+        space_ = 0;
+    }
+
+private:
+    size_t chunk_size_;
+    void* current_ = nullptr;
+    size_t space_ = 0;
+    std::vector<void*> chunks_;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Array cookies
+//
+// A deleter for `T[]` has to know how many elements to destroy without growing `UniquePtr`,
+// so the count is stored in front of the first element, like `new[]` does.
+
+template <typename T>
+constexpr size_t kArrayCookieSize = (sizeof(size_t) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+template <typename T>
+constexpr size_t kArrayAlign = alignof(T) > alignof(size_t) ? alignof(T) : alignof(size_t);
+
+template <typename T>
+T* PlaceArrayCookie(void* memory, size_t count) {
+    new (memory) size_t(count);
+    return reinterpret_cast<T*>(static_cast<char*>(memory) + kArrayCookieSize<T>);
+}
+
+template <typename T>
+void* GetArrayMemory(T* array) {
+    return reinterpret_cast<char*>(array) - kArrayCookieSize<T>;
+}
+
+template <typename T>
+size_t GetArrayCount(T* array) {
+    return *static_cast<size_t*>(GetArrayMemory(array));
+}
+
+// Default-constructs `count` elements; if one throws, destroys the constructed ones.
+template <typename T>
+void ConstructArray(T* array, size_t count) {
+    size_t constructed = 0;
+    try {
+        for (; constructed < count; ++constructed) {
+            new (array + constructed) T();
+        }
+    } catch (...) {
+        while (constructed-- > 0) {
+            array[constructed].~T();
+        }
+        throw;
+    }
+}
+
+template <typename T>
+void DestroyArray(T* array, size_t count) {
+    while (count-- > 0) {
+        array[count].~T();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Deleters
+
+// Destroys the object and returns its block to the pool. One pointer: `UniquePtr` takes two words.
+template <typename T>
+class PoolDeleter {
+public:
+    PoolDeleter() = default;
+
+    explicit PoolDeleter(FixedBlockPool* pool) : pool_(pool) {
+    }
+
+    void operator()(T* ptr) const {
+        if (ptr) {
+            ptr->~T();
+            pool_->Deallocate(ptr);
+        }
+    }
+
+    FixedBlockPool* GetPool() const {
+        return pool_;
+    }
+
+private:
+    FixedBlockPool* pool_ = nullptr;
+};
+
+template <typename T>
+class PoolDeleter<T[]> {
+public:
+    PoolDeleter() = default;
+
+    explicit PoolDeleter(FixedBlockPool* pool) : pool_(pool) {
+    }
+
+    void operator()(T* array) const {
+        if (array) {
+            DestroyArray(array, GetArrayCount(array));
+            pool_->Deallocate(GetArrayMemory(array));
+        }
+    }
+
+    FixedBlockPool* GetPool() const {
+        return pool_;
+    }
+
+private:
+    FixedBlockPool* pool_ = nullptr;
+};
+
+// Only runs the destructor: the memory goes back when the arena is reset. The deleter needs no
+// state, so `UniquePtr` stays one word, and for trivially destructible types it does nothing.
+template <typename T>
+struct ArenaDeleter {
+    void operator()(T* ptr) const {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            if (ptr) {
+                ptr->~T();
+            }
+        }
+    }
+};
+
+// Arrays of trivially destructible types are allocated without a cookie.
+template <typename T>
+struct ArenaDeleter<T[]> {
+    void operator()(T* array) const {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            if (array) {
+                DestroyArray(array, GetArrayCount(array));
+            }
+        }
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Factories
+
+template <typename T>
+using PoolUniquePtr = UniquePtr<T, PoolDeleter<T>>;
+
+template <typename T>
+using ArenaUniquePtr = UniquePtr<T, ArenaDeleter<T>>;
+
+// Throws `std::bad_alloc` if `T` does not fit into a block of `pool`.
+template <typename T, typename... Args>
+    requires(!std::is_array_v<T>)
+PoolUniquePtr<T> MakeUniqueFromPool(FixedBlockPool& pool, Args&&... args) {
+    if (sizeof(T) > pool.BlockSize() || alignof(T) > pool.BlockAlign()) {
+        throw std::bad_alloc();
+    }
+    void* memory = pool.Allocate();
+    try {
+        return PoolUniquePtr<T>(new (memory) T(std::forward<Args>(args)...),
+                                PoolDeleter<T>(&pool));
+    } catch (...) {
+        pool.Deallocate(memory);
+        throw;
+    }
+}
+
+// Throws `std::bad_alloc` if `count` elements and their count do not fit into a block of `pool`.
+template <typename T>
+    requires std::is_unbounded_array_v<T>
+PoolUniquePtr<T> MakeUniqueFromPool(FixedBlockPool& pool, size_t count) {
+    using Element = std::remove_extent_t<T>;
+    size_t capacity = (pool.BlockSize() - kArrayCookieSize<Element>) / sizeof(Element);
+    if (count > capacity || kArrayAlign<Element> > pool.BlockAlign()) {
+        throw std::bad_alloc();
+    }
+    void* memory = pool.Allocate();
+    Element* array = PlaceArrayCookie<Element>(memory, count);
+    try {
+        ConstructArray(array, count);
+    } catch (...) {
+        pool.Deallocate(memory);
+        throw;
+    }
+    return PoolUniquePtr<T>(array, PoolDeleter<T>(&pool));
+}
+
+template <typename T, typename... Args>
+    requires(!std::is_array_v<T>)
+ArenaUniquePtr<T> MakeUniqueInArena(Arena& arena, Args&&... args) {
+    void* memory = arena.Allocate(sizeof(T), alignof(T));
+    return ArenaUniquePtr<T>(new (memory) T(std::forward<Args>(args)...));
+}
+
+template <typename T>
+    requires std::is_unbounded_array_v<T>
+ArenaUniquePtr<T> MakeUniqueInArena(Arena& arena, size_t count) {
+    using Element = std::remove_extent_t<T>;
+    if (count > (size_t(-1) - kArrayCookieSize<Element>) / sizeof(Element)) {
+        throw std::bad_array_new_length();
+    }
+    Element* array;
+    if constexpr (std::is_trivially_destructible_v<Element>) {
+        array = static_cast<Element*>(arena.Allocate(sizeof(Element) * count, alignof(Element)));
+    } else {
+        void* memory = arena.Allocate(kArrayCookieSize<Element> + sizeof(Element) * count,
+                                      kArrayAlign<Element>);
+        array = PlaceArrayCookie<Element>(memory, count);
+    }
+    ConstructArray(array, count);
+    return ArenaUniquePtr<T>(array);
+}
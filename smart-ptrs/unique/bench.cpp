@@ -0,0 +1,132 @@
+#include "unique.h"
+#include "inline_unique.h"
+#include "unique_erased.h"
+
+#include <catch.hpp>
+
+#include <common/bench.h>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("Large buffer allocation", "[.][bench]") {
+    constexpr size_t kSize = 64 << 20;
+    constexpr size_t kIterations = 20;
+
+    // Zeroing touches every fresh page of the mapping, the buffer for overwrite touches none.
+    std::printf("allocate a 64 MB buffer:\n");
+    MeasureNsPerOp("MakeUnique<char[]> (zeroed)", kIterations, [] {
+        auto buffer = MakeUnique<char[]>(kSize);
+        DoNotOptimize(buffer.Get());
+    });
+    MeasureNsPerOp("MakeUniqueForOverwrite<char[]>", kIterations, [] {
+        auto buffer = MakeUniqueForOverwrite<char[]>(kSize);
+        DoNotOptimize(buffer.Get());
+    });
+
+    // Then written once in full, which is what an I/O buffer is for: zeroing is a second pass.
+    std::printf("allocate and fill a 64 MB buffer:\n");
+    MeasureNsPerOp("MakeUnique<char[]> (zeroed)", kIterations, [] {
+        auto buffer = MakeUnique<char[]>(kSize);
+        std::fill(buffer.Get(), buffer.Get() + kSize, 'x');
+        DoNotOptimize(buffer.Get());
+    });
+    MeasureNsPerOp("MakeUniqueForOverwrite<char[]>", kIterations, [] {
+        auto buffer = MakeUniqueForOverwrite<char[]>(kSize);
+        std::fill(buffer.Get(), buffer.Get() + kSize, 'x');
+        DoNotOptimize(buffer.Get());
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Handler {
+    virtual ~Handler() = default;
+    virtual int Handle(int value) const = 0;
+};
+
+struct Scaler : Handler {
+    explicit Scaler(int factor) : factor(factor) {
+    }
+
+    int Handle(int value) const override {
+        return value * factor;
+    }
+
+    int factor;
+};
+
+}  // namespace
+
+TEST_CASE("Small polymorphic handlers", "[.][bench]") {
+    constexpr size_t kHandlers = 10'000'000;
+
+    std::printf("create, call and destroy a small handler:\n");
+    MeasureNsPerOp("UniquePtr<Handler>", kHandlers, [] {
+        UniquePtr<Handler> handler(new Scaler(3));
+        DoNotOptimize(handler->Handle(2));
+    });
+    MeasureNsPerOp("InlineUniquePtr<Handler>", kHandlers, [] {
+        auto handler = MakeInlineUnique<Handler, Scaler>(3);
+        DoNotOptimize(handler->Handle(2));
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Task state too big for the small buffer of `std::function`, so both queues allocate it once.
+struct Job {
+    int Run() const {
+        return input[0] + input[7];
+    }
+
+    int input[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+};
+
+// The erased owner keeps the state alive, the function pointer knows what to do with it.
+struct ErasedTask {
+    UniqueErased state;
+    int (*run)(const void* state);
+};
+
+}  // namespace
+
+TEST_CASE("Queue of erased tasks", "[.][bench]") {
+    constexpr size_t kTasks = 10'000'000;
+    constexpr size_t kBatch = 1'000;
+
+    std::printf("enqueue, run and destroy a task:\n");
+    MeasureBatchNsPerOp("std::deque<std::function<int()>>", kTasks, [] {
+        std::deque<std::function<int()>> queue;
+        for (size_t done = 0; done < kTasks; done += kBatch) {
+            for (size_t i = 0; i < kBatch; ++i) {
+                queue.emplace_back([job = Job()] { return job.Run(); });
+            }
+            while (!queue.empty()) {
+                DoNotOptimize(queue.front()());
+                queue.pop_front();
+            }
+        }
+    });
+    MeasureBatchNsPerOp("std::deque<{UniqueErased, run}>", kTasks, [] {
+        std::deque<ErasedTask> queue;
+        for (size_t done = 0; done < kTasks; done += kBatch) {
+            for (size_t i = 0; i < kBatch; ++i) {
+                queue.push_back({MakeUnique<Job>(), [](const void* state) {
+                                     return static_cast<const Job*>(state)->Run();
+                                 }});
+            }
+            while (!queue.empty()) {
+                DoNotOptimize(queue.front().run(queue.front().state.Get()));
+                queue.pop_front();
+            }
+        }
+    });
+}
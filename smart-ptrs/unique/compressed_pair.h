@@ -1,258 +1,87 @@
 #pragma once
 
-// Paste here your implementation of compressed_pair from seminar 2 to use in UniquePtr
+#include <cstddef>
 #include <type_traits>
 #include <utility>
 
-template <typename T, typename V, bool IsTEmpty = std::is_empty_v<T> && !std::is_final_v<T>,
-          bool IsVEmpty = std::is_empty_v<V> && !std::is_final_v<V>,
-          bool IsSame = std::is_same_v<T, V>>
-class MakePair {};
-
-template <typename T, typename V>
-class MakePair<T, V, true, false, false> : public T {  // пустой только первый, разные
+// One element of a `CompressedPair`. An empty non-final type is stored as a base class, so it
+// takes no space (empty base optimization); anything else, references included, is a member.
+// `Index` makes the two elements distinct classes even when both have the same type.
+template <typename T, size_t Index, bool IsCompressed = std::is_empty_v<T> && !std::is_final_v<T>>
+class CompressedElement {
 public:
-    MakePair() : T(), second_() {
-    }
-
-    template <typename F, typename S>
-    MakePair(F&& first, S&& second) : T(std::forward<F>(first)), second_(std::forward<S>(second)) {
+    constexpr CompressedElement() : value_() {
     }
 
-    template <typename F, typename S>
-    MakePair(const F& first, const S& second) : F(first), second_(second) {
+    template <typename U>
+    constexpr explicit CompressedElement(U&& value) : value_(std::forward<U>(value)) {
     }
 
-    template <typename F, typename S>
-    MakePair(const F& first, S&& second) : F(first), second_(std::forward<S>(second)) {
+    constexpr T& Get() {
+        return value_;
     }
-
-    template <typename F, typename S>
-    MakePair(F&& first, const S& second) : F(std::forward<F>(first)), second_(second) {
-    }
-
-    T& GetFirst() {
-        return *this;
-    }
-    const T& GetFirst() const {
-        return *this;
-    }
-
-    V& GetSecond() {
-        return second_;
-    }
-    const V& GetSecond() const {
-        return second_;
+    constexpr const T& Get() const {
+        return value_;
     }
 
 private:
-    V second_;
+    T value_;
 };
 
-template <typename T, typename V>
-class MakePair<T, V, false, true, false> : public V {  // пустой только второй, разные
+template <typename T, size_t Index>
+class CompressedElement<T, Index, true> : private T {
 public:
-    MakePair() : first_(), V() {
+    constexpr CompressedElement() : T() {
     }
 
-    template <typename F, typename S>
-    MakePair(F&& first, S&& second) : first_(std::forward<F>(first)), S(std::forward<S>(second)) {
+    template <typename U>
+    constexpr explicit CompressedElement(U&& value) : T(std::forward<U>(value)) {
     }
 
-    template <typename F, typename S>
-    MakePair(const F& first, const S& second) : first_(first), S(second) {
-    }
-
-    template <typename F, typename S>
-    MakePair(const F& first, S&& second) : first_(first), S(std::forward<S>(second)) {
-    }
-
-    template <typename F, typename S>
-    MakePair(F&& first, const S& second) : first_(std::forward<F>(first)), S(second) {
-    }
-
-    T& GetFirst() {
-        return first_;
-    }
-    const T& GetFirst() const {
-        return first_;
-    }
-
-    V& GetSecond() {
+    constexpr T& Get() {
         return *this;
     }
-    const V& GetSecond() const {
+    constexpr const T& Get() const {
         return *this;
     }
-
-private:
-    T first_;
 };
 
+// Pair which stores empty elements (stateless deleters, lambdas without captures) for free, so
+// `sizeof(CompressedPair<T*, Deleter>) == sizeof(T*)` for them. Two empty elements of the same
+// type still take a byte each: distinct objects of one type need distinct addresses.
+//
+// Elements are always constructed in place from the forwarded arguments.
 template <typename F, typename S>
-class MakePair<F, S, true, true, false> : public F, public S {  // оба пустые и разные
-public:
-    MakePair() : F(), S() {
-    }
-
-    F& GetFirst() {
-        return *this;
-    }
-    const F& GetFirst() const {
-        return *this;
-    }
-
-    S& GetSecond() {
-        return *this;
-    }
-    const S& GetSecond() const {
-        return *this;
-    }
-
-    MakePair(F&& first, S&& second) : F(std::forward<F>(first)), S(std::forward<S>(second)) {
-    }
-
-    MakePair(const F& first, const S& second) : F(first), S(second) {
-    }
-
-    MakePair(const F& first, S&& second) : F(first), S(std::forward<S>(second)) {
-    }
-
-    MakePair(F&& first, const S& second) : F(std::forward<F>(first)), S(second) {
-    }
-};
-
-template <typename T, typename V>
-class MakePair<T, V, false, false, false> {
-public:
-    MakePair() : first_(), second_() {
-    }
-
-    template <typename F, typename S>
-    MakePair(F&& first, S&& second)
-        : first_(std::forward<F>(first)), second_(std::forward<S>(second)) {
-    }
+class CompressedPair : private CompressedElement<F, 0>, private CompressedElement<S, 1> {
+    using First = CompressedElement<F, 0>;
+    using Second = CompressedElement<S, 1>;
 
-    template <typename F, typename S>
-    MakePair(const F& first, const S& second) : first_(first), second_(second) {
-    }
-
-    template <typename F, typename S>
-    MakePair(const F& first, S&& second) : first_(first), second_(std::forward<S>(second)) {
-    }
-
-    template <typename F, typename S>
-    MakePair(F&& first, const S& second) : first_(std::forward<F>(first)), second_(second) {
-    }
-
-    T& GetFirst() {
-        return first_;
-    }
-    const T& GetFirst() const {
-        return first_;
-    }
-
-    V& GetSecond() {
-        return second_;
-    }
-    const V& GetSecond() const {
-        return second_;
-    }
-
-private:
-    T first_;
-    V second_;
-};  // оба разные и не пустые
-
-template <typename T, typename V>
-class MakePair<T, V, false, false, true> {
 public:
-    MakePair() : first_(), second_() {
-    }
-
-    template <typename F, typename S>
-    MakePair(F&& first, S&& second) : first_(std::forward<F>(first)), S(std::forward<S>(second)) {
-    }
-
-    template <typename F, typename S>
-    MakePair(const F& first, const S& second) : first_(first), S(second) {
-    }
-
-    template <typename F, typename S>
-    MakePair(const F& first, S&& second) : first_(first), S(std::forward<F>(second)) {
+    constexpr CompressedPair() : First(), Second() {
     }
 
-    template <typename F, typename S>
-    MakePair(F&& first, const S& second) : first_(std::forward<F>(first)), S(second) {
+    // The second element is value-initialized.
+    template <typename U>
+        requires(!std::is_same_v<std::remove_cvref_t<U>, CompressedPair>)
+    constexpr explicit CompressedPair(U&& first) : First(std::forward<U>(first)), Second() {
     }
 
-    T& GetFirst() {
-        return first_;
-    }
-    const T& GetFirst() const {
-        return first_;
+    template <typename U, typename V>
+    constexpr CompressedPair(U&& first, V&& second)
+        : First(std::forward<U>(first)), Second(std::forward<V>(second)) {
     }
 
-    V& GetSecond() {
-        return second_;
+    constexpr F& GetFirst() {
+        return First::Get();
     }
-    const V& GetSecond() const {
-        return second_;
+    constexpr const F& GetFirst() const {
+        return First::Get();
     }
 
-private:
-    T first_;
-    V second_;
-};  // оба одинаковые непустые
-
-template <typename T, typename V>
-class MakePair<T, V, true, true, true> : public T {
-public:
-    MakePair() : first_(), T() {
+    constexpr S& GetSecond() {
+        return Second::Get();
     }
-
-    template <typename F, typename S>
-    MakePair(F&& first, S&& second) : first_(std::forward<F>(first)), S(std::forward<S>(second)) {
+    constexpr const S& GetSecond() const {
+        return Second::Get();
     }
-
-    template <typename F, typename S>
-    MakePair(const F& first, const S& second) : first_(first), S(second) {
-    }
-
-    template <typename F, typename S>
-    MakePair(const F& first, S&& second) : first_(first), S(std::forward<T>(second)) {
-    }
-
-    template <typename F, typename S>
-    MakePair(F&& first, const S& second) : first_(std::forward<T>(first)), S(second) {
-    }
-
-    T& GetFirst() {
-        return *this;
-    }
-
-    const T& GetFirst() const {
-        return *this;
-    }
-
-    T& GetSecond() {
-        return *this;
-    }
-
-    const T& GetSecond() const {
-        return *this;
-    }
-
-private:
-    T first_;
-};  // оба одинаковые пустые
-
-template <typename F, typename S>
-class CompressedPair
-    : public MakePair<F, S, std::is_empty_v<F> && !std::is_final_v<F>,
-                      std::is_empty_v<S> && !std::is_final_v<S>, std::is_same_v<F, S>> {
-public:
-    using Define = MakePair<F, S, std::is_empty_v<F> && !std::is_final_v<F>,
-                            std::is_empty_v<S> && !std::is_final_v<S>, std::is_same_v<F, S>>;
-    using Define ::Define;
-};
\ No newline at end of file
+};
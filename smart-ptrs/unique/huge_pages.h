@@ -0,0 +1,38 @@
+#pragma once
+
+#include "unique.h"
+
+#include <common/huge_page_arena.h>
+
+#include <new>          // for placement new
+#include <type_traits>  // for std::is_array_v
+#include <utility>      // for std::forward
+
+// Destroys an object placed in a `HugePageArena`. Stateless, since a block knows its arena, so
+// `UniquePtr<T, HugePageDeleter<T>>` is a single pointer.
+template <typename T>
+struct HugePageDeleter {
+    void operator()(T* object) const {
+        if (object) {
+            object->~T();
+            HugePageArena::Deallocate(object);
+        }
+    }
+};
+
+template <typename T>
+using HugePageUniquePtr = UniquePtr<T, HugePageDeleter<T>>;
+
+template <typename T, typename... Args>
+    requires(!std::is_array_v<T>)
+HugePageUniquePtr<T> MakeUnique(HugePages place, Args&&... args) {
+    void* memory = place.arena.Allocate(sizeof(T), alignof(T));
+    T* object;
+    try {
+        object = new (memory) T(std::forward<Args>(args)...);
+    } catch (...) {
+        HugePageArena::Deallocate(memory);
+        throw;
+    }
+    return HugePageUniquePtr<T>(object);
+}
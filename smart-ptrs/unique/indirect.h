@@ -0,0 +1,282 @@
+#pragma once
+
+#include "compressed_pair.h"
+#include "unique.h"
+
+#include <concepts>  // for std::derived_from
+#include <memory>    // for std::allocator / std::allocator_traits
+#include <utility>   // for std::in_place_t / std::in_place_type_t
+
+// Owners with value semantics: copying one copies the owned object (through the allocator it was
+// created with), so classes holding a pimpl or a polymorphic member get their copy constructor
+// and assignment for free, without a hand-written virtual `Clone`.
+//
+// A moved-from owner is valueless: it owns nothing and allocated nothing. It may only be
+// assigned to, destroyed or checked with `IsValueless`.
+
+namespace indirect_detail {
+
+template <typename T, typename Alloc>
+using Traits = typename std::allocator_traits<Alloc>::template rebind_traits<T>;
+
+// Allocates and constructs a `T` with a rebound copy of `alloc`.
+template <typename T, typename Alloc, typename... Args>
+T* Create(const Alloc& alloc, Args&&... args) {
+    typename Traits<T, Alloc>::allocator_type typed(alloc);
+    T* object = Traits<T, Alloc>::allocate(typed, 1);
+    try {
+        Traits<T, Alloc>::construct(typed, object, std::forward<Args>(args)...);
+    } catch (...) {
+        Traits<T, Alloc>::deallocate(typed, object, 1);
+        throw;
+    }
+    return object;
+}
+
+template <typename T, typename Alloc>
+void Destroy(const Alloc& alloc, T* object) {
+    typename Traits<T, Alloc>::allocator_type typed(alloc);
+    Traits<T, Alloc>::destroy(typed, object);
+    Traits<T, Alloc>::deallocate(typed, object, 1);
+}
+
+}  // namespace indirect_detail
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Indirect
+
+// Frees an object created by `Indirect`. The allocator is stored as an empty base when it is
+// stateless, so `UniquePtr<T, IndirectDeleter<T, std::allocator<T>>>` is one pointer.
+template <typename T, typename Alloc>
+class IndirectDeleter : private CompressedElement<Alloc, 0> {
+public:
+    IndirectDeleter() = default;
+
+    explicit IndirectDeleter(const Alloc& alloc) : CompressedElement<Alloc, 0>(alloc) {
+    }
+
+    void operator()(T* object) const {
+        if (object) {
+            indirect_detail::Destroy(GetAllocator(), object);
+        }
+    }
+
+    const Alloc& GetAllocator() const {
+        return CompressedElement<Alloc, 0>::Get();
+    }
+};
+
+// A `T` on the heap which behaves like a `T` member: deep copies, `const` propagates.
+template <typename T, typename Alloc = std::allocator<T>>
+class Indirect {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+public:
+    Indirect()
+        requires std::default_initializable<T>
+        : Indirect(std::in_place) {
+    }
+
+    template <typename... Args>
+    explicit Indirect(std::in_place_t, Args&&... args)
+        : Indirect(std::allocator_arg, Alloc(), std::in_place, std::forward<Args>(args)...) {
+    }
+
+    template <typename... Args>
+    Indirect(std::allocator_arg_t, const Alloc& alloc, std::in_place_t, Args&&... args)
+        : ptr_(indirect_detail::Create<T>(alloc, std::forward<Args>(args)...),
+               IndirectDeleter<T, Alloc>(alloc)) {
+    }
+
+    Indirect(std::allocator_arg_t, const Alloc& alloc, const Indirect& other)
+        : ptr_(other.IsValueless() ? nullptr : indirect_detail::Create<T>(alloc, *other),
+               IndirectDeleter<T, Alloc>(alloc)) {
+    }
+
+    Indirect(const Indirect& other)
+        : Indirect(std::allocator_arg,
+                   AllocTraits::select_on_container_copy_construction(other.GetAllocator()),
+                   other) {
+    }
+
+    Indirect(Indirect&& other) noexcept = default;
+
+    // Assigns to the owned object in place when both sides have one.
+    Indirect& operator=(const Indirect& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.IsValueless()) {
+            ptr_.Reset();
+        } else if (IsValueless()) {
+            ptr_.Reset(indirect_detail::Create<T>(GetAllocator(), *other));
+        } else {
+            **this = *other;
+        }
+        return *this;
+    }
+
+    Indirect& operator=(Indirect&& other) noexcept = default;
+
+    T& operator*() {
+        return *ptr_.Get();
+    }
+    const T& operator*() const {
+        return *ptr_.Get();
+    }
+    T* operator->() {
+        return ptr_.Get();
+    }
+    const T* operator->() const {
+        return ptr_.Get();
+    }
+
+    bool IsValueless() const {
+        return !ptr_;
+    }
+
+    const Alloc& GetAllocator() const {
+        return ptr_.GetDeleter().GetAllocator();
+    }
+
+    void Swap(Indirect& other) noexcept {
+        ptr_.Swap(other.ptr_);
+    }
+
+private:
+    UniquePtr<T, IndirectDeleter<T, Alloc>> ptr_;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Polymorphic
+
+// How to copy and destroy the concrete type behind a `Base*`: one constant table per type, so the
+// copier costs a pointer and no virtual function in `Base`.
+template <typename Base, typename Alloc>
+struct PolymorphicOps {
+    Base* (*clone)(const Alloc& alloc, const Base* object);
+    void (*destroy)(const Alloc& alloc, Base* object);
+};
+
+template <typename Base, typename Derived, typename Alloc>
+inline constexpr PolymorphicOps<Base, Alloc> kPolymorphicOps = {
+    [](const Alloc& alloc, const Base* object) -> Base* {
+        return indirect_detail::Create<Derived>(alloc, static_cast<const Derived&>(*object));
+    },
+    [](const Alloc& alloc, Base* object) {
+        indirect_detail::Destroy(alloc, static_cast<Derived*>(object));
+    }};
+
+// The deleter of `Polymorphic`: the operations of the concrete type next to the allocator, which
+// takes no space when it is stateless.
+template <typename Base, typename Alloc>
+class PolymorphicDeleter {
+public:
+    using Ops = PolymorphicOps<Base, Alloc>;
+
+    PolymorphicDeleter() = default;
+
+    PolymorphicDeleter(const Ops* ops, const Alloc& alloc) : state_(ops, alloc) {
+    }
+
+    void operator()(Base* object) const {
+        if (object) {
+            GetOps()->destroy(GetAllocator(), object);
+        }
+    }
+
+    Base* Clone(const Base* object, const Alloc& alloc) const {
+        return GetOps()->clone(alloc, object);
+    }
+
+    const Ops* GetOps() const {
+        return state_.GetFirst();
+    }
+    const Alloc& GetAllocator() const {
+        return state_.GetSecond();
+    }
+
+private:
+    CompressedPair<const Ops*, Alloc> state_;
+};
+
+// An object of any type derived from `Base` (not virtually), copied as that type. `Base` needs
+// neither a virtual destructor nor a `Clone`.
+template <typename Base, typename Alloc = std::allocator<Base>>
+class Polymorphic {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using Deleter = PolymorphicDeleter<Base, Alloc>;
+
+public:
+    Polymorphic()
+        requires std::default_initializable<Base>
+        : Polymorphic(std::in_place_type<Base>) {
+    }
+
+    template <typename Derived, typename... Args>
+        requires std::derived_from<Derived, Base>
+    explicit Polymorphic(std::in_place_type_t<Derived>, Args&&... args)
+        : Polymorphic(std::allocator_arg, Alloc(), std::in_place_type<Derived>,
+                      std::forward<Args>(args)...) {
+    }
+
+    template <typename Derived, typename... Args>
+        requires std::derived_from<Derived, Base>
+    Polymorphic(std::allocator_arg_t, const Alloc& alloc, std::in_place_type_t<Derived>,
+                Args&&... args)
+        : ptr_(indirect_detail::Create<Derived>(alloc, std::forward<Args>(args)...),
+               Deleter(&kPolymorphicOps<Base, Derived, Alloc>, alloc)) {
+    }
+
+    Polymorphic(std::allocator_arg_t, const Alloc& alloc, const Polymorphic& other)
+        : ptr_(other.IsValueless() ? nullptr
+                                   : other.ptr_.GetDeleter().Clone(other.ptr_.Get(), alloc),
+               Deleter(other.ptr_.GetDeleter().GetOps(), alloc)) {
+    }
+
+    Polymorphic(const Polymorphic& other)
+        : Polymorphic(std::allocator_arg,
+                      AllocTraits::select_on_container_copy_construction(other.GetAllocator()),
+                      other) {
+    }
+
+    Polymorphic(Polymorphic&& other) noexcept = default;
+
+    // The dynamic type may change, so the object is copied and swapped in.
+    Polymorphic& operator=(const Polymorphic& other) {
+        if (this != &other) {
+            Polymorphic(std::allocator_arg, GetAllocator(), other).Swap(*this);
+        }
+        return *this;
+    }
+
+    Polymorphic& operator=(Polymorphic&& other) noexcept = default;
+
+    Base& operator*() {
+        return *ptr_.Get();
+    }
+    const Base& operator*() const {
+        return *ptr_.Get();
+    }
+    Base* operator->() {
+        return ptr_.Get();
+    }
+    const Base* operator->() const {
+        return ptr_.Get();
+    }
+
+    bool IsValueless() const {
+        return !ptr_;
+    }
+
+    const Alloc& GetAllocator() const {
+        return ptr_.GetDeleter().GetAllocator();
+    }
+
+    void Swap(Polymorphic& other) noexcept {
+        ptr_.Swap(other.ptr_);
+    }
+
+private:
+    UniquePtr<Base, Deleter> ptr_;
+};
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "unique.h"
+
+#include <cstddef>      // for size_t / std::max_align_t
+#include <new>          // for placement new
+#include <type_traits>  // for std::conditional_t / std::is_base_of_v
+#include <utility>      // for std::exchange
+
+// Default buffer: the whole `InlineUniquePtr` (buffer, object pointer, operations) is 64 bytes.
+inline constexpr size_t kInlineUniqueSize = 48;
+
+// Owner of a polymorphic object which stores the object in its own `N`-byte buffer when it fits
+// (size, alignment up to `alignof(std::max_align_t)` and a `noexcept` move constructor, so that
+// moving the owner can move the object), and in a heap-allocated `UniquePtr<Derived>` otherwise.
+//
+// The object is destroyed as the `Derived` it was created as, so `Base` needs no virtual
+// destructor, except to hand the object over to a `UniquePtr<Base>` with `Release`. Types which
+// may take the heap path should then be `final`: `UniquePtr<Derived>` deletes them as `Derived`,
+// which compilers only accept without a warning when no further derived type can exist.
+template <typename Base, size_t N = kInlineUniqueSize>
+class InlineUniquePtr {
+    static_assert(N >= sizeof(void*), "the buffer must hold at least the heap fallback");
+
+public:
+    template <typename Derived>
+    static constexpr bool kFitsInline = sizeof(Derived) <= N &&
+                                        alignof(Derived) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible_v<Derived>;
+
+    InlineUniquePtr() = default;
+
+    InlineUniquePtr(std::nullptr_t) {
+    }
+
+    // Takes over a heap object.
+    template <typename Derived>
+        requires std::is_base_of_v<Base, Derived>
+    InlineUniquePtr(UniquePtr<Derived>&& heap) {
+        if (heap) {
+            Adopt<Derived, false>(std::move(heap));
+        }
+    }
+
+    InlineUniquePtr(const InlineUniquePtr&) = delete;
+    InlineUniquePtr& operator=(const InlineUniquePtr&) = delete;
+
+    InlineUniquePtr(InlineUniquePtr&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    InlineUniquePtr& operator=(InlineUniquePtr&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    InlineUniquePtr& operator=(std::nullptr_t) {
+        Reset();
+        return *this;
+    }
+
+    ~InlineUniquePtr() {
+        Reset();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Destroys the current object and creates a `Derived` in its place.
+    template <typename Derived, typename... Args>
+        requires std::is_base_of_v<Base, Derived>
+    Derived& Emplace(Args&&... args) {
+        Reset();
+        if constexpr (kFitsInline<Derived>) {
+            Adopt<Derived, true>(std::forward<Args>(args)...);
+        } else {
+            Adopt<Derived, false>(new Derived(std::forward<Args>(args)...));
+        }
+        return static_cast<Derived&>(*ptr_);
+    }
+
+    void Reset() {
+        if (ops_) {
+            ops_->destroy(buffer_);
+            ops_ = nullptr;
+            ptr_ = nullptr;
+        }
+    }
+
+    // Hands the object over to a `UniquePtr<Base>`, moving it to the heap if it is inline.
+    UniquePtr<Base> Release() {
+        static_assert(std::has_virtual_destructor_v<Base>,
+                      "UniquePtr<Base> would destroy the object as a Base");
+        if (!ops_) {
+            return UniquePtr<Base>();
+        }
+        Base* released = ops_->release(buffer_);
+        ops_ = nullptr;
+        ptr_ = nullptr;
+        return UniquePtr<Base>(released);
+    }
+
+    void Swap(InlineUniquePtr& other) noexcept {
+        InlineUniquePtr tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    Base* Get() const {
+        return ptr_;
+    }
+    Base& operator*() const {
+        return *ptr_;
+    }
+    Base* operator->() const {
+        return ptr_;
+    }
+    explicit operator bool() const {
+        return ptr_ != nullptr;
+    }
+
+    // Whether the object lives in the buffer rather than on the heap.
+    bool IsInline() const {
+        return ops_ && ops_->is_inline;
+    }
+
+private:
+    struct Ops {
+        void (*destroy)(void* buffer);
+        Base* (*relocate)(void* from, void* to);
+        Base* (*release)(void* buffer);
+        bool is_inline;
+    };
+
+    // What the buffer holds: the object itself, or the `UniquePtr` owning it.
+    template <typename Derived, bool Inline>
+    struct Storage {
+        using Stored = std::conditional_t<Inline, Derived, UniquePtr<Derived>>;
+
+        static Base* GetBase(Stored& stored) {
+            if constexpr (Inline) {
+                return &stored;
+            } else {
+                return stored.Get();
+            }
+        }
+
+        static void Destroy(void* buffer) {
+            static_cast<Stored*>(buffer)->~Stored();
+        }
+
+        static Base* Relocate(void* from, void* to) {
+            auto* source = static_cast<Stored*>(from);
+            auto* target = new (to) Stored(std::move(*source));
+            source->~Stored();
+            return GetBase(*target);
+        }
+
+        static Base* Release(void* buffer) {
+            auto* stored = static_cast<Stored*>(buffer);
+            Base* released;
+            if constexpr (Inline) {
+                released = new Derived(std::move(*stored));
+            } else {
+                released = stored->Release();
+            }
+            stored->~Stored();
+            return released;
+        }
+
+        static constexpr Ops kOps = {&Destroy, &Relocate, &Release, Inline};
+    };
+
+    template <typename Derived, bool Inline, typename... Args>
+    void Adopt(Args&&... args) {
+        using Slot = Storage<Derived, Inline>;
+        auto* stored = new (buffer_) typename Slot::Stored(std::forward<Args>(args)...);
+        ptr_ = Slot::GetBase(*stored);
+        ops_ = &Slot::kOps;
+    }
+
+    void MoveFrom(InlineUniquePtr& other) noexcept {
+        if (other.ops_) {
+            ptr_ = other.ops_->relocate(other.buffer_, buffer_);
+            ops_ = std::exchange(other.ops_, nullptr);
+            other.ptr_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char buffer_[N];
+    Base* ptr_ = nullptr;
+    const Ops* ops_ = nullptr;
+};
+
+// `Derived` constructed inline if it fits, on the heap otherwise.
+template <typename Base, typename Derived, size_t N = kInlineUniqueSize, typename... Args>
+InlineUniquePtr<Base, N> MakeInlineUnique(Args&&... args) {
+    InlineUniquePtr<Base, N> result;
+    result.template Emplace<Derived>(std::forward<Args>(args)...);
+    return result;
+}
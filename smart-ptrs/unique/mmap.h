@@ -0,0 +1,113 @@
+#pragma once
+
+#include "unique.h"
+
+#include <cerrno>        // for errno
+#include <cstddef>       // for std::byte / size_t
+#include <system_error>  // for std::system_error
+#include <utility>       // for std::exchange
+
+#include <fcntl.h>     // for open
+#include <sys/mman.h>  // for mmap / munmap / madvise
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for close
+
+// Unmaps the region; the length of the mapping lives in the deleter, so
+// `UniquePtr<std::byte[], MmapDeleter>` is two words.
+class MmapDeleter {
+public:
+    MmapDeleter() = default;
+
+    explicit MmapDeleter(size_t length) : length_(length) {
+    }
+
+    MmapDeleter(MmapDeleter&& other) noexcept : length_(std::exchange(other.length_, 0)) {
+    }
+
+    MmapDeleter& operator=(MmapDeleter&& other) noexcept {
+        length_ = std::exchange(other.length_, 0);
+        return *this;
+    }
+
+    void operator()(std::byte* data) const {
+        if (data) {
+            munmap(data, length_);
+        }
+    }
+
+    size_t Length() const {
+        return length_;
+    }
+
+private:
+    size_t length_ = 0;
+};
+
+using MappedBuffer = UniquePtr<std::byte[], MmapDeleter>;
+
+struct MmapOptions {
+    // Fault every page in up front (`MAP_POPULATE`) instead of on first access.
+    bool populate = false;
+    // Ask for transparent huge pages (`MADV_HUGEPAGE`). Only a hint: ignored where unsupported.
+    bool huge_pages = false;
+};
+
+namespace mmap_detail {
+
+[[noreturn]] inline void ThrowErrno(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+inline MappedBuffer Map(size_t length, int flags, int fd, MmapOptions options) {
+    if (options.populate) {
+        flags |= MAP_POPULATE;
+    }
+    void* data = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, fd, 0);
+    if (data == MAP_FAILED) {
+        ThrowErrno("mmap");
+    }
+    if (options.huge_pages) {
+        madvise(data, length, MADV_HUGEPAGE);
+    }
+    return MappedBuffer(static_cast<std::byte*>(data), MmapDeleter(length));
+}
+
+}  // namespace mmap_detail
+
+// Maps the whole file privately: pages are shared with the page cache and only copied if this
+// process writes to them, so loading costs no read and no copy. An empty file maps to an empty
+// buffer. Throws `std::system_error` on failure.
+inline MappedBuffer MapFile(const char* path, MmapOptions options = {}) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        mmap_detail::ThrowErrno("open");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        mmap_detail::ThrowErrno("fstat");
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return MappedBuffer();
+    }
+    try {
+        MappedBuffer result =
+            mmap_detail::Map(static_cast<size_t>(info.st_size), MAP_PRIVATE, fd, options);
+        close(fd);
+        return result;
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
+
+// Zero-filled private memory straight from the kernel.
+inline MappedBuffer MapAnonymous(size_t length, MmapOptions options = {}) {
+    if (length == 0) {
+        return MappedBuffer();
+    }
+    return mmap_detail::Map(length, MAP_PRIVATE | MAP_ANONYMOUS, -1, options);
+}
@@ -0,0 +1,136 @@
+#include "allocators.h"
+
+#include <common/my_int.h>
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct ThrowsOnThird {
+    ThrowsOnThird() {
+        if (++constructed == 3) {
+            throw std::runtime_error("third");
+        }
+        ++alive;
+    }
+
+    ~ThrowsOnThird() {
+        --alive;
+    }
+
+    static inline int constructed = 0;
+    static inline int alive = 0;
+};
+
+struct alignas(64) Overaligned {
+    int value = 7;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("FixedBlockPool") {
+    FixedBlockPool pool(sizeof(MyInt), alignof(MyInt), 4);
+
+    SECTION("Blocks are recycled") {
+        void* first = pool.Allocate();
+        pool.Deallocate(first);
+        REQUIRE(pool.Allocate() == first);
+    }
+
+    SECTION("Grows by chunks") {
+        std::vector<void*> blocks;
+        for (int i = 0; i < 10; ++i) {
+            blocks.push_back(pool.Allocate());
+        }
+        for (void* block : blocks) {
+            REQUIRE(reinterpret_cast<uintptr_t>(block) % pool.BlockAlign() == 0);
+            pool.Deallocate(block);
+        }
+    }
+}
+
+TEST_CASE("MakeUniqueFromPool") {
+    FixedBlockPool pool(64);
+
+    SECTION("Single object") {
+        {
+            PoolUniquePtr<MyInt> a = MakeUniqueFromPool<MyInt>(pool, 5);
+            REQUIRE(*a.Get() == 5);
+            REQUIRE(a.GetDeleter().GetPool() == &pool);
+            REQUIRE(MyInt::AliveCount() == 1);
+
+            PoolUniquePtr<MyInt> b = std::move(a);
+            REQUIRE(!a);
+            REQUIRE(MyInt::AliveCount() == 1);
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+
+        void* recycled = pool.Allocate();
+        pool.Deallocate(recycled);
+        REQUIRE(MakeUniqueFromPool<MyInt>(pool, 1).Get() == recycled);
+    }
+
+    SECTION("Array") {
+        {
+            PoolUniquePtr<MyInt[]> array = MakeUniqueFromPool<MyInt[]>(pool, 4);
+            REQUIRE(MyInt::AliveCount() == 4);
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+
+    SECTION("Too large") {
+        REQUIRE_THROWS_AS(MakeUniqueFromPool<MyInt[]>(pool, 64), std::bad_alloc);
+        REQUIRE_THROWS_AS(MakeUniqueFromPool<Overaligned>(pool), std::bad_alloc);
+    }
+
+    SECTION("Constructor throws") {
+        ThrowsOnThird::constructed = 0;
+        REQUIRE_THROWS_AS(MakeUniqueFromPool<ThrowsOnThird[]>(pool, 4), std::runtime_error);
+        REQUIRE(ThrowsOnThird::alive == 0);
+    }
+}
+
+TEST_CASE("MakeUniqueInArena") {
+    Arena arena(256);
+
+    SECTION("Destructors run, memory stays") {
+        {
+            ArenaUniquePtr<MyInt> a = MakeUniqueInArena<MyInt>(arena, 1);
+            ArenaUniquePtr<MyInt[]> array = MakeUniqueInArena<MyInt[]>(arena, 3);
+            REQUIRE(MyInt::AliveCount() == 4);
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+        arena.Reset();
+    }
+
+    SECTION("Trivial types") {
+        ArenaUniquePtr<int[]> array = MakeUniqueInArena<int[]>(arena, 1000);
+        array[999] = 1;
+        ArenaUniquePtr<Overaligned> aligned = MakeUniqueInArena<Overaligned>(arena);
+        REQUIRE(reinterpret_cast<uintptr_t>(aligned.Get()) % alignof(Overaligned) == 0);
+        REQUIRE(aligned->value == 7);
+    }
+
+    SECTION("Constructor throws") {
+        ThrowsOnThird::constructed = 0;
+        REQUIRE_THROWS_AS(MakeUniqueInArena<ThrowsOnThird[]>(arena, 4), std::runtime_error);
+        REQUIRE(ThrowsOnThird::alive == 0);
+    }
+
+    SECTION("Sizes which overflow") {
+        REQUIRE_THROWS_AS(MakeUniqueInArena<int[]>(arena, SIZE_MAX / 4 + 1),
+                          std::bad_array_new_length);
+        REQUIRE_THROWS_AS(MakeUniqueInArena<MyInt[]>(arena, SIZE_MAX / sizeof(MyInt)),
+                          std::bad_array_new_length);
+        REQUIRE_THROWS_AS(arena.Allocate(SIZE_MAX - 8, 16), std::bad_alloc);
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+}
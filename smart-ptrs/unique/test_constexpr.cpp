@@ -0,0 +1,104 @@
+#include "unique.h"
+
+#include <catch.hpp>
+
+#include <utility>
+
+// Everything here is checked at compile time: a `UniquePtr` may allocate, move, reset and free
+// inside a constant expression, and empty ones need no dynamic initialization.
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Point {
+    int x;
+    int y;
+};
+
+template <typename T>
+struct CountingDeleter {
+    int* deleted;
+
+    constexpr void operator()(T* ptr) const {
+        ++*deleted;
+        delete ptr;
+    }
+};
+
+constexpr int MoveResetRelease() {
+    UniquePtr<int> ptr = MakeUnique<int>(5);
+    UniquePtr<int> moved = std::move(ptr);
+    int result = *moved + (ptr ? 100 : 0);
+    moved.Reset(new int(7));
+    result += *moved;
+    int* raw = moved.Release();
+    result += *raw + (moved == nullptr ? 0 : 100);
+    delete raw;
+    return result;
+}
+
+constexpr int SumArray(size_t count) {
+    UniquePtr<int[]> array = MakeUnique<int[]>(count);
+    for (size_t i = 0; i < count; ++i) {
+        array[i] = static_cast<int>(i);
+    }
+    int sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += array[i];
+    }
+    return sum;
+}
+
+constexpr int CountDeletions() {
+    int deleted = 0;
+    {
+        using Ptr = UniquePtr<Point, CountingDeleter<Point>>;
+        Ptr first(new Point{1, 2}, CountingDeleter<Point>{&deleted});
+        Ptr second(new Point{3, 4}, CountingDeleter<Point>{&deleted});
+        first.Swap(second);
+        if (first->x != 3 || (*second).y != 2) {
+            return -1;
+        }
+        second = std::move(first);
+        if (deleted != 1 || first) {
+            return -1;
+        }
+    }
+    return deleted;
+}
+
+constexpr bool CompressedPairWorks() {
+    CompressedPair<int, CountingDeleter<int>> pair(1, CountingDeleter<int>{nullptr});
+    pair.GetFirst() = 2;
+    return pair.GetFirst() == 2 && pair.GetSecond().deleted == nullptr;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constant evaluation
+
+static_assert(MoveResetRelease() == 19);
+static_assert(SumArray(10) == 45);
+static_assert(CountDeletions() == 2);
+static_assert(CompressedPairWorks());
+static_assert(!UniquePtr<int>());
+static_assert(UniquePtr<int[]>().Get() == nullptr);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constant initialization
+
+constinit UniquePtr<int> global_ptr;
+constinit UniquePtr<int[]> global_array;
+constinit UniquePtr<Point, CountingDeleter<Point>> global_with_deleter;
+
+TEST_CASE("Constant-initialized UniquePtr") {
+    REQUIRE(!global_ptr);
+    REQUIRE(!global_array);
+    REQUIRE(!global_with_deleter);
+
+    global_ptr = MakeUnique<int>(3);
+    REQUIRE(*global_ptr == 3);
+    global_ptr.Reset();
+}
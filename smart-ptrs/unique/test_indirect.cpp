@@ -0,0 +1,200 @@
+#include "indirect.h"
+
+#include <catch.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct AllocatorStats {
+    size_t allocated = 0;
+    size_t deallocated = 0;
+};
+
+template <typename T>
+class CountingAllocator {
+public:
+    using value_type = T;
+
+    explicit CountingAllocator(AllocatorStats* stats) : stats_(stats) {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) : stats_(other.Stats()) {
+    }
+
+    T* allocate(size_t count) {
+        ++stats_->allocated;
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* ptr, size_t count) {
+        ++stats_->deallocated;
+        std::allocator<T>().deallocate(ptr, count);
+    }
+
+    AllocatorStats* Stats() const {
+        return stats_;
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const {
+        return stats_ == other.Stats();
+    }
+
+private:
+    AllocatorStats* stats_;
+};
+
+int shapes_alive = 0;
+
+// No virtual destructor and no `Clone`: `Polymorphic` copies and destroys the concrete type.
+struct Shape {
+    Shape() {
+        ++shapes_alive;
+    }
+    Shape(const Shape&) {
+        ++shapes_alive;
+    }
+    ~Shape() {
+        --shapes_alive;
+    }
+
+    virtual std::string Name() const {
+        return "shape";
+    }
+};
+
+struct Square : Shape {
+    explicit Square(int side) : side(side) {
+    }
+
+    std::string Name() const override {
+        return "square " + std::to_string(side);
+    }
+
+    int side;
+    std::vector<int> payload = std::vector<int>(4, 1);
+};
+
+// A value type with a pimpl and a polymorphic member: copyable without writing any copy code.
+struct Widget {
+    Indirect<std::string> name{std::in_place, "widget"};
+    Polymorphic<Shape> shape{std::in_place_type<Square>, 2};
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static_assert(sizeof(Indirect<std::string>) == sizeof(void*));
+static_assert(sizeof(Polymorphic<Shape>) == 2 * sizeof(void*));
+
+TEST_CASE("Indirect") {
+    SECTION("Deep copies") {
+        Indirect<std::string> first(std::in_place, "value");
+        Indirect<std::string> second = first;
+        REQUIRE(*second == "value");
+        REQUIRE(&*second != &*first);
+        *second += "!";
+        REQUIRE(*first == "value");
+
+        first = second;
+        REQUIRE(*first == "value!");
+        REQUIRE(first->size() == 6);
+    }
+
+    SECTION("Const propagates") {
+        const Indirect<std::string> constant(std::in_place, "x");
+        static_assert(std::is_same_v<decltype(*constant), const std::string&>);
+        static_assert(std::is_same_v<decltype(constant.operator->()), const std::string*>);
+        REQUIRE(*constant == "x");
+    }
+
+    SECTION("Moved-from is valueless and allocates nothing") {
+        AllocatorStats stats;
+        CountingAllocator<int> alloc(&stats);
+        Indirect<int, CountingAllocator<int>> first(std::allocator_arg, alloc, std::in_place, 5);
+        REQUIRE(stats.allocated == 1);
+        auto second = std::move(first);
+        REQUIRE(first.IsValueless());
+        REQUIRE(*second == 5);
+        REQUIRE(stats.allocated == 1);
+
+        first = second;
+        REQUIRE(!first.IsValueless());
+        REQUIRE(*first == 5);
+        REQUIRE(stats.allocated == 2);
+
+        Indirect<int, CountingAllocator<int>> empty = std::move(second);
+        second = std::move(empty);
+        first = std::move(empty);
+        REQUIRE(first.IsValueless());
+        REQUIRE(stats.deallocated == 1);
+    }
+
+    SECTION("Default constructed holds a value") {
+        Indirect<std::vector<int>> vector;
+        REQUIRE(!vector.IsValueless());
+        REQUIRE(vector->empty());
+    }
+}
+
+TEST_CASE("Polymorphic") {
+    SECTION("Copies keep the dynamic type") {
+        {
+            Polymorphic<Shape> square(std::in_place_type<Square>, 3);
+            Polymorphic<Shape> copy = square;
+            REQUIRE(copy->Name() == "square 3");
+            REQUIRE(&*copy != &*square);
+            REQUIRE(shapes_alive == 2);
+
+            Polymorphic<Shape> shape;
+            REQUIRE(shape->Name() == "shape");
+            shape = copy;
+            REQUIRE(shape->Name() == "square 3");
+            REQUIRE(shapes_alive == 3);
+        }
+        REQUIRE(shapes_alive == 0);
+    }
+
+    SECTION("Moves do not allocate") {
+        AllocatorStats stats;
+        CountingAllocator<Shape> alloc(&stats);
+        using Ptr = Polymorphic<Shape, CountingAllocator<Shape>>;
+        {
+            Ptr square(std::allocator_arg, alloc, std::in_place_type<Square>, 4);
+            Ptr moved = std::move(square);
+            REQUIRE(square.IsValueless());
+            REQUIRE(moved->Name() == "square 4");
+            REQUIRE(stats.allocated == 1);
+
+            square = moved;
+            REQUIRE(square->Name() == "square 4");
+            REQUIRE(stats.allocated == 2);
+        }
+        REQUIRE(stats.deallocated == 2);
+        REQUIRE(shapes_alive == 0);
+    }
+
+    SECTION("Value types copy their members") {
+        {
+            Widget widget;
+            Widget copy = widget;
+            *copy.name = "copy";
+            copy.shape = Polymorphic<Shape>(std::in_place_type<Square>, 5);
+            REQUIRE(*widget.name == "widget");
+            REQUIRE(widget.shape->Name() == "square 2");
+            REQUIRE(copy.shape->Name() == "square 5");
+
+            std::vector<Widget> widgets(3, widget);
+            widgets.push_back(std::move(copy));
+            REQUIRE(widgets.back().shape->Name() == "square 5");
+        }
+        REQUIRE(shapes_alive == 0);
+    }
+}
@@ -0,0 +1,159 @@
+#include "inline_unique.h"
+
+#include <catch.hpp>
+
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+int alive = 0;
+
+// No virtual destructor: `InlineUniquePtr` must destroy objects as what they are.
+struct Handler {
+    virtual int Handle(int value) const = 0;
+};
+
+struct Adder : Handler {
+    explicit Adder(int delta) : delta(delta) {
+        ++alive;
+    }
+    Adder(Adder&& other) noexcept : delta(other.delta) {
+        ++alive;
+    }
+    ~Adder() {
+        --alive;
+    }
+
+    int Handle(int value) const override {
+        return value + delta;
+    }
+
+    int delta;
+};
+
+struct Big final : Handler {
+    Big() {
+        ++alive;
+    }
+    ~Big() {
+        --alive;
+    }
+
+    int Handle(int value) const override {
+        return value + padding[0];
+    }
+
+    char padding[128] = {};
+};
+
+// Could throw while moving: kept on the heap so that moving the owner never does.
+struct Throwing final : Handler {
+    Throwing() = default;
+    Throwing(const Throwing&) {
+    }
+
+    int Handle(int value) const override {
+        return -value;
+    }
+};
+
+struct Shape {
+    virtual ~Shape() = default;
+    virtual std::string Name() const = 0;
+};
+
+struct Circle : Shape {
+    std::string Name() const override {
+        return "circle";
+    }
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static_assert(sizeof(InlineUniquePtr<Handler>) == 64);
+static_assert(InlineUniquePtr<Handler>::kFitsInline<Adder>);
+static_assert(!InlineUniquePtr<Handler>::kFitsInline<Big>);
+static_assert(!InlineUniquePtr<Handler>::kFitsInline<Throwing>);
+
+TEST_CASE("InlineUniquePtr") {
+    SECTION("Small objects live inline") {
+        {
+            auto handler = MakeInlineUnique<Handler, Adder>(2);
+            REQUIRE(handler.IsInline());
+            REQUIRE(handler->Handle(40) == 42);
+            REQUIRE(alive == 1);
+        }
+        REQUIRE(alive == 0);
+    }
+
+    SECTION("Large objects go to the heap") {
+        {
+            auto handler = MakeInlineUnique<Handler, Big>();
+            REQUIRE(!handler.IsInline());
+            REQUIRE(handler->Handle(1) == 1);
+            auto other = MakeInlineUnique<Handler, Throwing>();
+            REQUIRE(!other.IsInline());
+            REQUIRE(other->Handle(1) == -1);
+        }
+        REQUIRE(alive == 0);
+    }
+
+    SECTION("Moves relocate inline objects") {
+        auto handler = MakeInlineUnique<Handler, Adder>(1);
+        InlineUniquePtr<Handler> moved = std::move(handler);
+        REQUIRE(!handler);
+        REQUIRE(handler.Get() == nullptr);
+        REQUIRE(moved.IsInline());
+        REQUIRE(moved.Get() != nullptr);
+        REQUIRE(moved->Handle(1) == 2);
+        REQUIRE(alive == 1);
+
+        auto big = MakeInlineUnique<Handler, Big>();
+        Handler* object = big.Get();
+        moved = std::move(big);
+        REQUIRE(moved.Get() == object);
+        REQUIRE(alive == 1);
+
+        moved.Swap(handler);
+        REQUIRE(!moved);
+        REQUIRE(handler.Get() == object);
+        handler = nullptr;
+        REQUIRE(alive == 0);
+    }
+
+    SECTION("Emplace and Reset") {
+        InlineUniquePtr<Handler> handler;
+        REQUIRE(!handler.IsInline());
+        Adder& adder = handler.Emplace<Adder>(5);
+        REQUIRE(&adder == handler.Get());
+        handler.Emplace<Big>();
+        REQUIRE(alive == 1);
+        handler.Reset();
+        REQUIRE(alive == 0);
+    }
+
+    SECTION("Adopting and releasing heap objects") {
+        InlineUniquePtr<Shape> shape(UniquePtr<Circle>(new Circle));
+        REQUIRE(!shape.IsInline());
+        REQUIRE(shape->Name() == "circle");
+        UniquePtr<Shape> released = shape.Release();
+        REQUIRE(!shape);
+        REQUIRE(released->Name() == "circle");
+
+        shape = MakeInlineUnique<Shape, Circle>();
+        REQUIRE(shape.IsInline());
+        released = shape.Release();
+        REQUIRE(!shape);
+        REQUIRE(released->Name() == "circle");
+    }
+
+    SECTION("Custom buffer size") {
+        auto handler = MakeInlineUnique<Handler, Big, 256>();
+        REQUIRE(handler.IsInline());
+        REQUIRE(alive == 1);
+    }
+}
@@ -0,0 +1,167 @@
+#include "unique.h"
+#include "allocators.h"
+#include "deleters.h"
+#include "unique_array.h"
+#include "unique_erased.h"
+#include "unique_resource.h"
+
+#include <catch.hpp>
+
+#include <type_traits>
+
+// Everything here is checked at compile time: the target fails to build if a layout regresses.
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Empty {};
+struct OtherEmpty {};
+struct FinalEmpty final {};
+struct Word {
+    void* value;
+};
+
+template <typename T>
+struct FunctionObjectDeleter {
+    void operator()(T* ptr) const {
+        delete ptr;
+    }
+};
+
+template <typename T>
+struct DerivedDeleter : Deleter<T> {};
+
+auto lambda_deleter = [](int* ptr) { delete ptr; };
+auto array_lambda_deleter = [](int* ptr) { delete[] ptr; };
+int counter = 0;
+auto capturing_deleter = [&c = counter](int* ptr) {
+    ++c;
+    delete ptr;
+};
+
+// The layout without compression: a pointer next to the deleter.
+template <typename D>
+struct PointerAndDeleter {
+    int* ptr;
+    D deleter;
+};
+
+template <typename D>
+constexpr size_t kPointerAndDeleter = sizeof(PointerAndDeleter<D>);
+
+template <typename P>
+constexpr bool kMovable = std::is_nothrow_move_constructible_v<P> &&
+                          std::is_nothrow_move_assignable_v<P> &&
+                          !std::is_copy_constructible_v<P> && !std::is_copy_assignable_v<P>;
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// CompressedPair
+
+static_assert(sizeof(CompressedPair<Empty, Word>) == sizeof(Word));
+static_assert(sizeof(CompressedPair<Word, Empty>) == sizeof(Word));
+static_assert(sizeof(CompressedPair<Empty, OtherEmpty>) == 1);
+static_assert(sizeof(CompressedPair<Word, Word>) == 2 * sizeof(Word));
+// Two objects of one type cannot share an address, and a final class cannot be a base.
+static_assert(sizeof(CompressedPair<Empty, Empty>) == 2);
+static_assert(sizeof(CompressedPair<Word, FinalEmpty>) == 2 * sizeof(Word));
+static_assert(sizeof(CompressedPair<int*, int&>) == 2 * sizeof(void*));
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Stateless deleters: exactly one pointer
+
+static_assert(sizeof(UniquePtr<int>) == sizeof(int*));
+static_assert(sizeof(UniquePtr<int, Slug<int>>) == sizeof(int*));
+static_assert(sizeof(UniquePtr<int[]>) == sizeof(int*));
+static_assert(sizeof(UniquePtr<int[], Slug<int[]>>) == sizeof(int*));
+static_assert(sizeof(UniquePtr<void, Slug<void>>) == sizeof(void*));
+static_assert(sizeof(UniquePtr<int, FunctionObjectDeleter<int>>) == sizeof(int*));
+static_assert(sizeof(UniquePtr<int, decltype(lambda_deleter)>) == sizeof(int*));
+static_assert(sizeof(UniquePtr<int[], decltype(array_lambda_deleter)>) == sizeof(int*));
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Stateful deleters from deleters.h: a pointer next to the deleter, nothing more
+
+static_assert(sizeof(UniquePtr<int, Deleter<int>>) == kPointerAndDeleter<Deleter<int>>);
+static_assert(sizeof(UniquePtr<int[], Deleter<int[]>>) == kPointerAndDeleter<Deleter<int[]>>);
+static_assert(sizeof(UniquePtr<int, CopyableDeleter<int>>) ==
+              kPointerAndDeleter<CopyableDeleter<int>>);
+static_assert(sizeof(UniquePtr<int, DerivedDeleter<int>>) ==
+              kPointerAndDeleter<DerivedDeleter<int>>);
+static_assert(sizeof(UniquePtr<int, decltype(capturing_deleter)>) ==
+              kPointerAndDeleter<decltype(capturing_deleter)>);
+static_assert(sizeof(UniquePtr<int, void (*)(int*)>) == kPointerAndDeleter<void (*)(int*)>);
+static_assert(sizeof(UniquePtr<int, CopyableDeleter<int>&>) ==
+              kPointerAndDeleter<CopyableDeleter<int>&>);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pool and arena deleters: at most two words
+
+static_assert(sizeof(PoolUniquePtr<int>) == 2 * sizeof(void*));
+static_assert(sizeof(PoolUniquePtr<int[]>) == 2 * sizeof(void*));
+static_assert(sizeof(ArenaUniquePtr<int>) == sizeof(void*));
+static_assert(sizeof(ArenaUniquePtr<int[]>) == sizeof(void*));
+
+// The length and the alignment live in the deleter.
+static_assert(sizeof(UniqueArray<float>) == 3 * sizeof(void*));
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Moves construct the deleter in place, so move-only deleters work
+
+static_assert(kMovable<UniquePtr<int>>);
+static_assert(kMovable<UniquePtr<int[]>>);
+static_assert(kMovable<UniquePtr<int, Deleter<int>>>);
+static_assert(kMovable<UniquePtr<int[], Deleter<int[]>>>);
+static_assert(kMovable<UniquePtr<int, CopyableDeleter<int>>>);
+static_assert(kMovable<UniquePtr<int, DerivedDeleter<int>>>);
+static_assert(kMovable<PoolUniquePtr<int[]>>);
+static_assert(kMovable<ArenaUniquePtr<int>>);
+static_assert(kMovable<UniqueArray<float>>);
+static_assert(std::is_nothrow_constructible_v<UniquePtr<int, Deleter<int>>,
+                                              UniquePtr<int, DerivedDeleter<int>>&&>);
+
+TEST_CASE("UniquePtr layout") {
+    UniquePtr<int, decltype(lambda_deleter)> ptr(new int(1), lambda_deleter);
+    UniquePtr<int, decltype(lambda_deleter)> moved(std::move(ptr));
+    REQUIRE(*moved == 1);
+    REQUIRE(!ptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// UniqueErased: the data pointer and the destroy function, whatever it owns
+
+static_assert(sizeof(UniqueErased) == 2 * sizeof(void*));
+static_assert(std::is_constructible_v<UniqueErased, UniquePtr<int>&&>);
+static_assert(std::is_constructible_v<UniqueErased, UniquePtr<int[]>&&>);
+static_assert(std::is_constructible_v<UniqueErased, UniquePtr<int, decltype(lambda_deleter)>&&>);
+// A deleter with state has nowhere to go.
+static_assert(
+    !std::is_constructible_v<UniqueErased, UniquePtr<int, decltype(capturing_deleter)>&&>);
+static_assert(!std::is_constructible_v<UniqueErased, UniquePtr<int>&>);
+static_assert(kMovable<UniqueErased>);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// UniqueResource: the handle alone with a stateless deleter
+
+namespace {
+
+struct Pair {
+    int first;
+    int second;
+
+    constexpr bool operator==(const Pair&) const = default;
+};
+
+auto handle_deleter = [](int) {};
+
+}  // namespace
+
+static_assert(sizeof(UniqueFd) == sizeof(int));
+static_assert(sizeof(UniqueResource<int, decltype(handle_deleter), -1>) == sizeof(int));
+static_assert(sizeof(UniqueResource<Pair, decltype(handle_deleter)>) == sizeof(Pair));
+static_assert(sizeof(UniqueResource<int, void (*)(int)>) == 2 * sizeof(void*));
+static_assert(kMovable<UniqueFd>);
+static_assert(!UniqueFd());
+static_assert(UniqueFd::kSentinel == -1);
@@ -0,0 +1,70 @@
+#include "unique.h"
+
+#include <common/my_int.h>
+
+#include <catch.hpp>
+
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Point {
+    int x;
+    int y;
+};
+
+template <typename T>
+concept CanMakeUnique = requires { MakeUnique<T>(); };
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("MakeUnique") {
+    SECTION("Single object") {
+        UniquePtr<std::string> str = MakeUnique<std::string>(3, 'a');
+        REQUIRE(*str == "aaa");
+
+        UniquePtr<Point> point = MakeUnique<Point>();
+        REQUIRE(point->x == 0);
+        REQUIRE(point->y == 0);
+    }
+
+    SECTION("Array is value-initialized") {
+        UniquePtr<int[]> array = MakeUnique<int[]>(100);
+        for (size_t i = 0; i < 100; ++i) {
+            REQUIRE(array[i] == 0);
+        }
+    }
+
+    SECTION("Destructors") {
+        {
+            auto single = MakeUnique<MyInt>(5);
+            auto array = MakeUnique<MyInt[]>(3);
+            REQUIRE(MyInt::AliveCount() == 4);
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+
+    SECTION("Bounded arrays are rejected") {
+        static_assert(CanMakeUnique<int>);
+        static_assert(!CanMakeUnique<int[4]>);
+    }
+}
+
+TEST_CASE("MakeUniqueForOverwrite") {
+    UniquePtr<Point> point = MakeUniqueForOverwrite<Point>();
+    point->x = 1;
+    REQUIRE(point->x == 1);
+
+    UniquePtr<char[]> buffer = MakeUniqueForOverwrite<char[]>(1 << 20);
+    buffer[(1 << 20) - 1] = 'x';
+    REQUIRE(buffer[(1 << 20) - 1] == 'x');
+
+    {
+        auto strings = MakeUniqueForOverwrite<std::string[]>(2);
+        REQUIRE(strings[1].empty());
+    }
+}
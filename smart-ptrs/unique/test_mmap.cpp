@@ -0,0 +1,86 @@
+#include "mmap.h"
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// A temporary file with the given contents, removed at scope exit.
+class TempFile {
+public:
+    explicit TempFile(const std::string& contents) {
+        int fd = mkstemp(path_);
+        REQUIRE(fd >= 0);
+        REQUIRE(write(fd, contents.data(), contents.size()) ==
+                static_cast<ssize_t>(contents.size()));
+        close(fd);
+    }
+
+    ~TempFile() {
+        unlink(path_);
+    }
+
+    const char* Path() const {
+        return path_;
+    }
+
+private:
+    char path_[32] = "/tmp/mmap_test_XXXXXX";
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("MapFile") {
+    SECTION("Contents") {
+        TempFile file("hello, mapping");
+        MappedBuffer buffer = MapFile(file.Path());
+        REQUIRE(buffer.GetDeleter().Length() == 14);
+        REQUIRE(std::memcmp(buffer.Get(), "hello, mapping", 14) == 0);
+        static_assert(sizeof(MappedBuffer) == 2 * sizeof(void*));
+    }
+
+    SECTION("Private writes do not reach the file") {
+        TempFile file("abc");
+        {
+            MappedBuffer buffer = MapFile(file.Path(), {.populate = true});
+            buffer[0] = std::byte{'x'};
+        }
+        MappedBuffer again = MapFile(file.Path());
+        REQUIRE(again[0] == std::byte{'a'});
+    }
+
+    SECTION("Empty file") {
+        TempFile file("");
+        REQUIRE(!MapFile(file.Path()));
+    }
+
+    SECTION("Missing file") {
+        REQUIRE_THROWS_AS(MapFile("/nonexistent/file"), std::system_error);
+    }
+}
+
+TEST_CASE("MapAnonymous") {
+    constexpr size_t kLength = 4 << 20;
+    MappedBuffer buffer = MapAnonymous(kLength, {.populate = true, .huge_pages = true});
+    REQUIRE(buffer.GetDeleter().Length() == kLength);
+    REQUIRE(buffer[kLength - 1] == std::byte{0});
+    buffer[kLength - 1] = std::byte{1};
+
+    MappedBuffer moved = std::move(buffer);
+    REQUIRE(moved.GetDeleter().Length() == kLength);
+    REQUIRE(buffer.GetDeleter().Length() == 0);
+    REQUIRE(moved[kLength - 1] == std::byte{1});
+
+    REQUIRE(!MapAnonymous(0));
+}
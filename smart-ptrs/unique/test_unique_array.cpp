@@ -0,0 +1,88 @@
+#include "unique_array.h"
+
+#include <common/my_int.h>
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+bool IsAligned(const void* ptr, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("UniqueArray") {
+    SECTION("Alignment") {
+        for (size_t alignment : {kAvxAlignment, kCacheLineAlignment, kPageAlignment}) {
+            UniqueArray<float> array = MakeUniqueArray<float>(1000, alignment);
+            REQUIRE(array.Size() == 1000);
+            REQUIRE(array.Alignment() == alignment);
+            REQUIRE(IsAligned(array.Data(), alignment));
+        }
+    }
+
+    SECTION("Value-initialized") {
+        UniqueArray<int> array = MakeUniqueArray<int>(100, kCacheLineAlignment);
+        REQUIRE(std::accumulate(array.begin(), array.end(), 0) == 0);
+    }
+
+    SECTION("Iteration and span") {
+        UniqueArray<int> array = MakeUniqueArrayForOverwrite<int>(10, kAvxAlignment);
+        std::iota(array.begin(), array.end(), 0);
+        int sum = 0;
+        for (int value : array) {
+            sum += value;
+        }
+        REQUIRE(sum == 45);
+        std::span<int> span = array.Span();
+        REQUIRE(span.size() == 10);
+        REQUIRE(span[9] == 9);
+        REQUIRE(array[3] == 3);
+    }
+
+    SECTION("Moves transfer the length") {
+        UniqueArray<int> array = MakeUniqueArray<int>(8, kCacheLineAlignment);
+        int* data = array.Data();
+        UniqueArray<int> moved = std::move(array);
+        REQUIRE(moved.Data() == data);
+        REQUIRE(moved.Size() == 8);
+        REQUIRE(array.Data() == nullptr);
+        REQUIRE(array.Empty());
+
+        array = std::move(moved);
+        REQUIRE(array.Size() == 8);
+        array.Reset();
+        REQUIRE(array.Empty());
+    }
+
+    SECTION("Destructors") {
+        {
+            UniqueArray<MyInt> array = MakeUniqueArray<MyInt>(5, kCacheLineAlignment);
+            REQUIRE(MyInt::AliveCount() == 5);
+        }
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+
+    SECTION("Empty and invalid") {
+        REQUIRE(MakeUniqueArray<int>(0).Empty());
+        REQUIRE_THROWS_AS(MakeUniqueArray<int>(1, 48), std::invalid_argument);
+    }
+
+    SECTION("Too many elements") {
+        constexpr size_t kTooMany = SIZE_MAX / sizeof(MyInt) + 1;
+        REQUIRE_THROWS_AS(MakeUniqueArray<MyInt>(kTooMany), std::bad_array_new_length);
+        REQUIRE_THROWS_AS(MakeUniqueArrayForOverwrite<int>(SIZE_MAX / sizeof(int) + 1),
+                          std::bad_array_new_length);
+        REQUIRE(MyInt::AliveCount() == 0);
+    }
+}
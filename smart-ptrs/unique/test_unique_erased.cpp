@@ -0,0 +1,114 @@
+#include "unique_erased.h"
+
+#include <catch.hpp>
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+int alive = 0;
+int freed = 0;
+
+struct Tracked {
+    explicit Tracked(int value) : value(value) {
+        ++alive;
+    }
+    ~Tracked() {
+        --alive;
+    }
+
+    int value;
+};
+
+// Counts what it frees, without any state of its own.
+struct CountingDelete {
+    void operator()(Tracked* ptr) const {
+        ++freed;
+        delete ptr;
+    }
+};
+
+struct Free {
+    void operator()(void* ptr) const {
+        free(ptr);
+    }
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("UniqueErased owns objects of any type") {
+    alive = 0;
+    {
+        UniqueErased number(MakeUnique<Tracked>(7));
+        UniqueErased text(MakeUnique<std::string>("owned"));
+        UniqueErased array(
+            UniquePtr<Tracked[]>(new Tracked[3]{Tracked(1), Tracked(2), Tracked(3)}));
+        REQUIRE(alive == 4);
+
+        REQUIRE(number.GetAs<Tracked>()->value == 7);
+        REQUIRE(*text.GetAs<std::string>() == "owned");
+        REQUIRE(array.GetAs<Tracked>()[2].value == 3);
+    }
+    REQUIRE(alive == 0);
+}
+
+TEST_CASE("UniqueErased takes over the object without copying it") {
+    auto ptr = MakeUnique<Tracked>(1);
+    Tracked* raw = ptr.Get();
+    UniqueErased erased(std::move(ptr));
+    REQUIRE(!ptr);
+    REQUIRE(erased.Get() == raw);
+}
+
+TEST_CASE("UniqueErased destroys with the original deleter") {
+    freed = 0;
+    alive = 0;
+    {
+        UniqueErased erased(UniquePtr<Tracked, CountingDelete>(new Tracked(5)));
+        UniqueErased malloced(UniquePtr<void, Free>(malloc(100)));
+        REQUIRE(freed == 0);
+    }
+    REQUIRE(freed == 1);
+    REQUIRE(alive == 0);
+
+    UniqueErased raw(malloc(16), &free);
+    REQUIRE(raw);
+}
+
+TEST_CASE("UniqueErased moves, resets and releases") {
+    alive = 0;
+    UniqueErased first(MakeUnique<Tracked>(1));
+    UniqueErased second(std::move(first));
+    REQUIRE(!first);
+    REQUIRE(second.GetAs<Tracked>()->value == 1);
+
+    UniqueErased third(MakeUnique<Tracked>(3));
+    third = std::move(second);
+    REQUIRE(alive == 1);
+    REQUIRE(third.GetAs<Tracked>()->value == 1);
+
+    first = MakeUnique<Tracked>(2);
+    first.Swap(third);
+    REQUIRE(first.GetAs<Tracked>()->value == 1);
+    REQUIRE(third.GetAs<Tracked>()->value == 2);
+
+    auto destroy = third.GetDestroyFunction();
+    void* released = third.Release();
+    REQUIRE(!third);
+    REQUIRE(alive == 2);
+    destroy(released);
+    REQUIRE(alive == 1);
+
+    first.Reset();
+    REQUIRE(!first);
+    REQUIRE(alive == 0);
+
+    first = nullptr;
+    REQUIRE(!first);
+}
@@ -0,0 +1,153 @@
+#include "unique_resource.h"
+
+#include <catch.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+std::vector<int> released;
+
+// Remembers what it frees instead of freeing it.
+struct Recorder {
+    void operator()(int handle) const {
+        released.push_back(handle);
+    }
+};
+
+using Recorded = UniqueResource<int, Recorder, -1>;
+
+bool IsOpen(int fd) {
+    return fcntl(fd, F_GETFD) != -1 || errno != EBADF;
+}
+
+// A handle which is not one word: a mapping is its address and its length.
+struct Region {
+    void* data = nullptr;
+    size_t length = 0;
+
+    bool operator==(const Region&) const = default;
+};
+
+struct Unmap {
+    void operator()(Region region) const {
+        munmap(region.data, region.length);
+    }
+};
+
+using UniqueRegion = UniqueResource<Region, Unmap>;
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("UniqueResource frees the handle once") {
+    released.clear();
+    {
+        Recorded empty;
+        REQUIRE(!empty);
+        REQUIRE(empty.Get() == -1);
+
+        Recorded handle(3);
+        REQUIRE(handle);
+        REQUIRE(handle.Get() == 3);
+    }
+    REQUIRE(released == std::vector<int>{3});
+}
+
+TEST_CASE("UniqueResource treats zero as a handle") {
+    released.clear();
+    {
+        Recorded zero(0);
+        REQUIRE(zero);
+    }
+    REQUIRE(released == std::vector<int>{0});
+}
+
+TEST_CASE("UniqueResource moves") {
+    released.clear();
+    Recorded first(1);
+    Recorded second(std::move(first));
+    REQUIRE(!first);
+    REQUIRE(second.Get() == 1);
+
+    Recorded third(3);
+    third = std::move(second);
+    REQUIRE(released == std::vector<int>{3});
+    REQUIRE(third.Get() == 1);
+
+    third = std::move(third);
+    REQUIRE(third.Get() == 1);
+    REQUIRE(released == std::vector<int>{3});
+}
+
+TEST_CASE("UniqueResource resets, releases and swaps") {
+    released.clear();
+    Recorded handle(1);
+    handle.Reset(2);
+    REQUIRE(released == std::vector<int>{1});
+    handle.Reset(2);
+    REQUIRE(released == std::vector<int>{1});
+
+    REQUIRE(handle.Release() == 2);
+    REQUIRE(!handle);
+
+    Recorded other(5);
+    handle.Swap(other);
+    REQUIRE(handle.Get() == 5);
+    REQUIRE(!other);
+
+    handle.Reset();
+    REQUIRE(released == std::vector<int>{1, 5});
+}
+
+TEST_CASE("UniqueFd closes descriptors") {
+    int raw[2];
+    REQUIRE(pipe(raw) == 0);
+    {
+        UniqueFd read_end(raw[0]);
+        UniqueFd write_end(raw[1]);
+        REQUIRE(write(write_end.Get(), "x", 1) == 1);
+        char byte = 0;
+        REQUIRE(read(read_end.Get(), &byte, 1) == 1);
+        REQUIRE(byte == 'x');
+    }
+    REQUIRE(!IsOpen(raw[0]));
+    REQUIRE(!IsOpen(raw[1]));
+
+    int epoll;
+    {
+        UniqueFd handle(epoll_create1(EPOLL_CLOEXEC));
+        REQUIRE(handle);
+        epoll = handle.Get();
+        REQUIRE(IsOpen(epoll));
+    }
+    REQUIRE(!IsOpen(epoll));
+
+    // A failed call returns the sentinel: nothing to close.
+    UniqueFd failed(open("/nonexistent/file", O_RDONLY));
+    REQUIRE(!failed);
+}
+
+TEST_CASE("UniqueResource with a handle of two words") {
+    constexpr size_t kLength = 1 << 16;
+    void* data = mmap(nullptr, kLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    REQUIRE(data != MAP_FAILED);
+    {
+        UniqueRegion region(Region{data, kLength});
+        static_cast<char*>(region.Get().data)[kLength - 1] = 'x';
+    }
+    unsigned char resident = 0;
+    REQUIRE(mincore(data, 1, &resident) == -1);
+    REQUIRE(errno == ENOMEM);
+}
@@ -8,75 +8,58 @@
 
 template <typename T>
 struct Slug {
-    Slug() = default;
+    constexpr Slug() = default;
 
     template <typename U>
-    Slug(const Slug<U>&) {
+    constexpr Slug(const Slug<U>&) {
     }
 
-    void operator()(T* ptr) const {
+    constexpr void operator()(T* ptr) const {
         static_assert(!std::is_void_v<T>);
         static_assert(sizeof(T) > 0);
         delete ptr;
     }
 };
 
+// A `void*` does not say what to destroy: `UniquePtr<void>` needs a deleter which knows the type.
+// For owners of objects of any type see `UniqueErased` (unique_erased.h).
 template <>
 struct Slug<void> {
-    void operator()(void* p) {
-        int* x = reinterpret_cast<int*>(p);
-        delete x;
-    }
+    void operator()(void*) const = delete;
 };
 
 template <typename T>
 struct Slug<T[]> {
-    void operator()(T* ptr) const {
+    constexpr void operator()(T* ptr) const {
         delete[] ptr;
     }
 };
 
-// Primary template
+// Primary template. Everything is `constexpr` (as `std::unique_ptr` is in C++23): a `UniquePtr`
+// works in constant evaluation, and an empty global one can be `constinit`.
 template <class T, typename Deleter = Slug<T>>
 class UniquePtr {
 public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
-    explicit UniquePtr(T* ptr = nullptr) noexcept : object_(ptr, Deleter()){};
+    constexpr explicit UniquePtr(T* ptr = nullptr) noexcept : object_(ptr){};
 
-    UniquePtr(T* ptr, Deleter deleter) {
-        object_ = CompressedPair<T*, Deleter>(ptr, std::forward<Deleter>(deleter));
-    };
+    constexpr UniquePtr(T* ptr, Deleter deleter) : object_(ptr, std::forward<Deleter>(deleter)){};
 
     UniquePtr(const UniquePtr&) = delete;
 
-    UniquePtr(UniquePtr&& other) noexcept {
-        object_ = CompressedPair<T*, Deleter>(static_cast<T*>(other.Release()),
-                                              std::forward<Deleter>(other.GetDeleter()));
-    };
+    constexpr UniquePtr(UniquePtr&& other) noexcept
+        : object_(other.Release(), std::forward<Deleter>(other.GetDeleter())){};
 
     template <class U, class OtherDeleter = Slug<U>>
-    UniquePtr(UniquePtr<U, OtherDeleter>&& other) noexcept {
-        // object_ = CompressedPair((other.Release()),
-        // std::forward<OtherDeleter>(other.GetDeleter()));
-        object_.GetFirst() = other.Release();
-        object_.GetSecond() = std::forward<OtherDeleter>(other.GetDeleter());
-    };
-
-    //    template <class U>
-    //    explicit UniquePtr(UniquePtr<U>&& other) noexcept
-    //        : object_((CompressedPair<U*, Slug<U*>>((std::forward<U*>(other.Release())),
-    //                                                std::forward<Slug<U*>>(other.GetDeleter())))){};
-
-    //    : object_(
-    //         (CompressedPair<U*, OtherDeleter>((std::forward<U*>(other.Release())),
-    //                                           std::forward<OtherDeleter>(other.GetDeleter()))))
+    constexpr UniquePtr(UniquePtr<U, OtherDeleter>&& other) noexcept
+        : object_(other.Release(), std::forward<OtherDeleter>(other.GetDeleter())){};
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // `operator=`-s
     auto&& operator=(const UniquePtr& other) = delete;
-    auto&& operator=(UniquePtr&& other) noexcept {
+    constexpr auto&& operator=(UniquePtr&& other) noexcept {
         if (other.Get() != this->object_.GetFirst()) {
             Reset(other.Release());
             object_.GetSecond() = std::forward<Deleter>(other.GetDeleter());
@@ -85,7 +68,7 @@ public:
     };
 
     template <class U, class OtherDeleter = Slug<U>>
-    auto&& operator=(UniquePtr<U, OtherDeleter>&& other) noexcept {
+    constexpr auto&& operator=(UniquePtr<U, OtherDeleter>&& other) noexcept {
         if (other.Get() != this->object_.GetFirst()) {
             auto temp = other.Release();
             Reset(temp);
@@ -94,7 +77,7 @@ public:
         return *this;
     };
 
-    auto&& operator=(std::nullptr_t) noexcept {
+    constexpr auto&& operator=(std::nullptr_t) noexcept {
         Reset();
         return *this;
     };
@@ -102,19 +85,19 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Destructor
 
-    ~UniquePtr() noexcept {
+    constexpr ~UniquePtr() noexcept {
         Reset();
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Modifiers
 
-    T* Release() noexcept {
+    constexpr T* Release() noexcept {
         auto tmp = object_.GetFirst();
         object_.GetFirst() = nullptr;
         return tmp;
     };
-    void Reset(T* ptr = nullptr) noexcept {
+    constexpr void Reset(T* ptr = nullptr) noexcept {
         if (ptr != object_.GetFirst()) {
             auto old_ptr = object_.GetFirst();
             object_.GetFirst() = ptr;
@@ -122,7 +105,7 @@ public:
         }
     };
 
-    void Swap(UniquePtr& other) noexcept {
+    constexpr void Swap(UniquePtr& other) noexcept {
         std::swap(object_.GetFirst(), other.object_.GetFirst());
         std::swap(object_.GetSecond(), other.object_.GetSecond());
     };
@@ -130,26 +113,26 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Observers
 
-    T* Get() const noexcept {
+    constexpr T* Get() const noexcept {
         return object_.GetFirst();
     };
-    Deleter& GetDeleter() {
+    constexpr Deleter& GetDeleter() {
         return object_.GetSecond();
     };
-    const Deleter& GetDeleter() const {
+    constexpr const Deleter& GetDeleter() const {
         return object_.GetSecond();
     };
-    explicit operator bool() const noexcept {
+    constexpr explicit operator bool() const noexcept {
         return (object_.GetFirst() != nullptr);
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Single-object dereference operators
 
-    T operator*() const {
+    constexpr T operator*() const {
         return *object_.GetFirst();
     };
-    T* operator->() const noexcept {
+    constexpr T* operator->() const noexcept {
         return object_.GetFirst();
     };
 
@@ -164,29 +147,21 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
-    explicit UniquePtr(T* ptr = nullptr) noexcept : object_({ptr, Deleter()}){};
+    constexpr explicit UniquePtr(T* ptr = nullptr) noexcept : object_(ptr){};
     UniquePtr(const UniquePtr&) = delete;
-    UniquePtr(T* ptr, Deleter deleter) : object_({ptr, std::move(deleter)}) {
-        object_.GetSecond() = std::move(deleter);
-    };
+    constexpr UniquePtr(T* ptr, Deleter deleter) : object_(ptr, std::forward<Deleter>(deleter)){};
 
-    UniquePtr(UniquePtr&& other) noexcept
-        : object_({std::move(other.object_.GetFirst()), std::move(other.object_.GetSecond())}) {
-        other.Reset();
-    };
+    constexpr UniquePtr(UniquePtr&& other) noexcept
+        : object_(other.Release(), std::forward<Deleter>(other.GetDeleter())){};
 
     template <class U, class OtherDeleter = Slug<U>>
-    UniquePtr(UniquePtr<U, OtherDeleter>&& other) noexcept {
-        // object_ = CompressedPair((other.Release()),
-        // std::forward<OtherDeleter>(other.GetDeleter()));
-        object_.GetFirst() = other.Release();
-        object_.GetSecond() = std::forward<OtherDeleter>(other.GetDeleter());
-    };
+    constexpr UniquePtr(UniquePtr<U, OtherDeleter>&& other) noexcept
+        : object_(other.Release(), std::forward<OtherDeleter>(other.GetDeleter())){};
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // `operator=`-s
     UniquePtr& operator=(const UniquePtr& rhs) = delete;
-    UniquePtr& operator=(UniquePtr&& other) noexcept {
+    constexpr UniquePtr& operator=(UniquePtr&& other) noexcept {
         if (this != &other) {
             Reset(other.Release());
             object_.GetSecond() = std::move(other.object_.GetSecond());
@@ -195,7 +170,7 @@ public:
     };
 
     template <class U, class OtherDeleter = Slug<U>>
-    auto&& operator=(UniquePtr<U, OtherDeleter>&& other) noexcept {
+    constexpr auto&& operator=(UniquePtr<U, OtherDeleter>&& other) noexcept {
         if (other.Get() != this->object_.GetFirst()) {
             auto temp = other.Release();
             Reset(temp);
@@ -203,7 +178,7 @@ public:
         }
         return *this;
     };
-    UniquePtr& operator=(std::nullptr_t) noexcept {
+    constexpr UniquePtr& operator=(std::nullptr_t) noexcept {
         Reset();
         return *this;
     };
@@ -211,28 +186,27 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Destructor
 
-    ~UniquePtr() noexcept {
+    constexpr ~UniquePtr() noexcept {
         Reset();
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Modifiers
 
-    T* Release() noexcept {
+    constexpr T* Release() noexcept {
         T* tmp = object_.GetFirst();
         object_.GetFirst() = nullptr;
         return tmp;
     };
-    void Reset(T* ptr = nullptr) {
+    constexpr void Reset(T* ptr = nullptr) {
         if (object_.GetFirst() != ptr) {
             T* old_ptr = object_.GetFirst();
             object_.GetFirst() = ptr;
-            object_.GetFirst() = ptr;
             object_.GetSecond()(old_ptr);
         }
     };
 
-    void Swap(UniquePtr& other) noexcept {
+    constexpr void Swap(UniquePtr& other) noexcept {
         std::swap(object_.GetFirst(), other.object_.GetFirst());
         std::swap(object_.GetSecond(), other.object_.GetSecond());
     };
@@ -240,23 +214,23 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Observers
 
-    T* Get() const {
+    constexpr T* Get() const {
         return object_.GetFirst();
     };
-    Deleter& GetDeleter() {
+    constexpr Deleter& GetDeleter() {
         return object_.GetSecond();
     };
-    const Deleter& GetDeleter() const {
+    constexpr const Deleter& GetDeleter() const {
         return object_.GetSecond();
     };
-    explicit operator bool() const {
+    constexpr explicit operator bool() const {
         return object_.GetFirst() != nullptr;
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Array dereference operators
 
-    T& operator[](size_t index) const {
+    constexpr T& operator[](size_t index) const {
         return object_.GetFirst()[index];
     };
 
@@ -266,31 +240,69 @@ private:
 };
 
 template <typename T1, typename D1, typename T2, typename D2>
-bool operator==(const UniquePtr<T1, D1>& p1, const UniquePtr<T2, D2>& p2) {
+constexpr bool operator==(const UniquePtr<T1, D1>& p1, const UniquePtr<T2, D2>& p2) {
     return p1.Get() == p2.Get();
 }
 
 template <typename T1, typename D1, typename T2, typename D2>
-bool operator!=(const UniquePtr<T1, D1>& p1, const UniquePtr<T2, D2>& p2) {
+constexpr bool operator!=(const UniquePtr<T1, D1>& p1, const UniquePtr<T2, D2>& p2) {
     return p1.Get() != p2.Get();
 }
 
 template <typename T, typename D>
-bool operator==(const UniquePtr<T, D>& p, std::nullptr_t) noexcept {
+constexpr bool operator==(const UniquePtr<T, D>& p, std::nullptr_t) noexcept {
     return p.Get() == nullptr;
 }
 
 template <typename T, typename D>
-bool operator==(std::nullptr_t, const UniquePtr<T, D>& p) noexcept {
+constexpr bool operator==(std::nullptr_t, const UniquePtr<T, D>& p) noexcept {
     return nullptr == p.Get();
 }
 
 template <typename T, typename D>
-bool operator!=(const UniquePtr<T, D>& p, std::nullptr_t) noexcept {
+constexpr bool operator!=(const UniquePtr<T, D>& p, std::nullptr_t) noexcept {
     return p.Get() != nullptr;
 }
 
 template <typename T, typename D>
-bool operator!=(std::nullptr_t, const UniquePtr<T, D>& p) noexcept {
+constexpr bool operator!=(std::nullptr_t, const UniquePtr<T, D>& p) noexcept {
     return nullptr != p.Get();
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Factories
+
+template <typename T, typename... Args>
+    requires(!std::is_array_v<T>)
+constexpr UniquePtr<T> MakeUnique(Args&&... args) {
+    return UniquePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+// `count` value-initialized elements: zeroed for trivial types.
+template <typename T>
+    requires std::is_unbounded_array_v<T>
+constexpr UniquePtr<T> MakeUnique(size_t count) {
+    return UniquePtr<T>(new std::remove_extent_t<T>[count]());
+}
+
+template <typename T, typename... Args>
+    requires std::is_bounded_array_v<T>
+void MakeUnique(Args&&...) = delete;
+
+// Default-initializes instead: a trivial object is left uninitialized, so a buffer which is about
+// to be overwritten is not written (and, for fresh pages, not even touched) twice.
+template <typename T>
+    requires(!std::is_array_v<T>)
+constexpr UniquePtr<T> MakeUniqueForOverwrite() {
+    return UniquePtr<T>(new T);
+}
+
+template <typename T>
+    requires std::is_unbounded_array_v<T>
+constexpr UniquePtr<T> MakeUniqueForOverwrite(size_t count) {
+    return UniquePtr<T>(new std::remove_extent_t<T>[count]);
+}
+
+template <typename T, typename... Args>
+    requires std::is_bounded_array_v<T>
+void MakeUniqueForOverwrite(Args&&...) = delete;
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "unique.h"
+
+#include <cstddef>      // for size_t
+#include <new>          // for std::align_val_t / std::bad_array_new_length
+#include <span>         // for std::span
+#include <stdexcept>    // for std::invalid_argument
+#include <type_traits>  // for std::is_trivially_destructible_v
+#include <utility>      // for std::exchange
+
+// Alignments worth asking for: AVX registers, cache lines and pages.
+inline constexpr size_t kAvxAlignment = 32;
+inline constexpr size_t kCacheLineAlignment = 64;
+inline constexpr size_t kPageAlignment = 4096;
+
+// Destroys `count` elements and frees them with the aligned, sized `operator delete` matching
+// the allocation. The deleter is where `UniqueArray` keeps its length.
+template <typename T>
+class AlignedArrayDeleter {
+public:
+    AlignedArrayDeleter() = default;
+
+    AlignedArrayDeleter(size_t count, size_t alignment) : count_(count), alignment_(alignment) {
+    }
+
+    AlignedArrayDeleter(AlignedArrayDeleter&& other) noexcept
+        : count_(std::exchange(other.count_, 0)), alignment_(other.alignment_) {
+    }
+
+    AlignedArrayDeleter& operator=(AlignedArrayDeleter&& other) noexcept {
+        count_ = std::exchange(other.count_, 0);
+        alignment_ = other.alignment_;
+        return *this;
+    }
+
+    void operator()(T* array) const {
+        if (!array) {
+            return;
+        }
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = count_; i-- > 0;) {
+                array[i].~T();
+            }
+        }
+        ::operator delete(array, count_ * sizeof(T), std::align_val_t(alignment_));
+    }
+
+    size_t Count() const {
+        return count_;
+    }
+    size_t Alignment() const {
+        return alignment_;
+    }
+
+private:
+    size_t count_ = 0;
+    size_t alignment_ = alignof(T);
+};
+
+// Owning array which knows its length and whose first element is aligned to `Alignment()`.
+// Three words: the pointer, the length and the alignment.
+template <typename T>
+class UniqueArray {
+public:
+    UniqueArray() = default;
+
+    // Takes ownership of `count` constructed elements allocated with
+    // `operator new(count * sizeof(T), std::align_val_t(alignment))`.
+    UniqueArray(T* data, size_t count, size_t alignment)
+        : ptr_(data, AlignedArrayDeleter<T>(count, alignment)) {
+    }
+
+    T* Data() const {
+        return ptr_.Get();
+    }
+    size_t Size() const {
+        return ptr_.GetDeleter().Count();
+    }
+    bool Empty() const {
+        return Size() == 0;
+    }
+    size_t Alignment() const {
+        return ptr_.GetDeleter().Alignment();
+    }
+
+    T& operator[](size_t index) const {
+        return ptr_[index];
+    }
+
+    T* begin() const {
+        return Data();
+    }
+    T* end() const {
+        return Data() + Size();
+    }
+
+    std::span<T> Span() const {
+        return {Data(), Size()};
+    }
+
+    void Reset() {
+        ptr_.Reset();
+        ptr_.GetDeleter() = AlignedArrayDeleter<T>();
+    }
+
+    void Swap(UniqueArray& other) {
+        ptr_.Swap(other.ptr_);
+    }
+
+private:
+    UniquePtr<T[], AlignedArrayDeleter<T>> ptr_;
+};
+
+namespace unique_array_detail {
+
+enum class Init { kValue, kDefault };
+
+template <typename T, Init init>
+UniqueArray<T> Make(size_t count, size_t alignment) {
+    if (alignment < alignof(T)) {
+        alignment = alignof(T);
+    }
+    if ((alignment & (alignment - 1)) != 0) {
+        throw std::invalid_argument("alignment must be a power of two");
+    }
+    if (count == 0) {
+        return UniqueArray<T>();
+    }
+    if (count > size_t(-1) / sizeof(T)) {
+        throw std::bad_array_new_length();
+    }
+    size_t bytes = count * sizeof(T);
+    T* data = static_cast<T*>(::operator new(bytes, std::align_val_t(alignment)));
+    size_t constructed = 0;
+    try {
+        for (; constructed < count; ++constructed) {
+            if constexpr (init == Init::kValue) {
+                new (data + constructed) T();
+            } else {
+                new (data + constructed) T;
+            }
+        }
+    } catch (...) {
+        while (constructed-- > 0) {
+            data[constructed].~T();
+        }
+        ::operator delete(data, bytes, std::align_val_t(alignment));
+        throw;
+    }
+    return UniqueArray<T>(data, count, alignment);
+}
+
+}  // namespace unique_array_detail
+
+// `count` value-initialized (zeroed for trivial types) elements aligned to `alignment`.
+template <typename T>
+UniqueArray<T> MakeUniqueArray(size_t count, size_t alignment = alignof(T)) {
+    return unique_array_detail::Make<T, unique_array_detail::Init::kValue>(count, alignment);
+}
+
+// Same, but default-initialized: trivial elements are left as the allocator returned them,
+// which saves touching (and zeroing) every page of a buffer about to be overwritten.
+template <typename T>
+UniqueArray<T> MakeUniqueArrayForOverwrite(size_t count, size_t alignment = alignof(T)) {
+    return unique_array_detail::Make<T, unique_array_detail::Init::kDefault>(count, alignment);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "unique.h"
+
+#include <cstddef>      // for std::nullptr_t
+#include <type_traits>  // for std::is_empty_v / std::remove_pointer_t
+#include <utility>      // for std::exchange / std::swap
+
+// Owner of an object of any type: the data pointer and the function destroying it, two words and
+// no allocation of its own. Built from a `UniquePtr<T, D>` with a stateless deleter, which it
+// takes over as is: the object is not moved or reallocated, and `D` is recreated to destroy it.
+//
+// Meant for heterogeneous queues and registries which only have to keep objects alive.
+class UniqueErased {
+public:
+    using DestroyFunction = void (*)(void*);
+
+    UniqueErased() = default;
+
+    UniqueErased(std::nullptr_t) {
+    }
+
+    // `destroy` is called with `data` (if not null) when the owner dies, e.g. `free` for `malloc`.
+    UniqueErased(void* data, DestroyFunction destroy) : data_(data), destroy_(destroy) {
+    }
+
+    template <typename T, typename Deleter>
+        requires std::is_empty_v<Deleter> && std::is_default_constructible_v<Deleter>
+    UniqueErased(UniquePtr<T, Deleter>&& ptr)
+        : data_(const_cast<void*>(static_cast<const volatile void*>(ptr.Release()))),
+          destroy_(&Destroy<std::remove_pointer_t<decltype(ptr.Get())>, Deleter>) {
+    }
+
+    UniqueErased(const UniqueErased&) = delete;
+    UniqueErased& operator=(const UniqueErased&) = delete;
+
+    UniqueErased(UniqueErased&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), destroy_(other.destroy_) {
+    }
+
+    UniqueErased& operator=(UniqueErased&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            data_ = std::exchange(other.data_, nullptr);
+            destroy_ = other.destroy_;
+        }
+        return *this;
+    }
+
+    ~UniqueErased() {
+        Reset();
+    }
+
+    void Reset() {
+        if (data_) {
+            destroy_(std::exchange(data_, nullptr));
+        }
+    }
+
+    // Gives up ownership; the caller destroys the object with `GetDestroyFunction()`.
+    void* Release() {
+        return std::exchange(data_, nullptr);
+    }
+
+    void Swap(UniqueErased& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(destroy_, other.destroy_);
+    }
+
+    void* Get() const {
+        return data_;
+    }
+
+    // The object as the `T` it was created as; the caller vouches for the type.
+    template <typename T>
+    T* GetAs() const {
+        return static_cast<T*>(data_);
+    }
+
+    DestroyFunction GetDestroyFunction() const {
+        return destroy_;
+    }
+
+    explicit operator bool() const {
+        return data_ != nullptr;
+    }
+
+private:
+    template <typename T, typename Deleter>
+    static void Destroy(void* data) {
+        Deleter deleter;
+        deleter(static_cast<T*>(data));
+    }
+
+    void* data_ = nullptr;
+    DestroyFunction destroy_ = nullptr;
+};
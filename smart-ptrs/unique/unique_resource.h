@@ -0,0 +1,113 @@
+#pragma once
+
+#include "compressed_pair.h"
+
+#include <type_traits>  // for std::is_nothrow_move_constructible_v
+#include <utility>      // for std::exchange / std::swap
+
+#include <unistd.h>  // for close
+
+// Owner of a handle which is not a pointer (a file descriptor, an epoll handle, a region given by
+// address and length), stored by value: no heap wrapper is needed to put it in a `UniquePtr`.
+// `Sentinel` is the handle of an empty owner; the deleter is never called with it.
+//
+// Move-only with the interface of `UniquePtr`. With a stateless deleter it is exactly
+// `sizeof(Handle)`; `Handle` must be usable as a template argument and comparable with `==`.
+template <typename Handle, typename Deleter, Handle Sentinel = Handle{}>
+class UniqueResource {
+public:
+    static constexpr Handle kSentinel = Sentinel;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    constexpr UniqueResource() : resource_(Sentinel) {
+    }
+
+    constexpr explicit UniqueResource(Handle handle) : resource_(std::move(handle)) {
+    }
+
+    constexpr UniqueResource(Handle handle, Deleter deleter)
+        : resource_(std::move(handle), std::forward<Deleter>(deleter)) {
+    }
+
+    UniqueResource(const UniqueResource&) = delete;
+
+    constexpr UniqueResource(UniqueResource&& other) noexcept
+        : resource_(other.Release(), std::forward<Deleter>(other.GetDeleter())) {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    UniqueResource& operator=(const UniqueResource&) = delete;
+
+    constexpr UniqueResource& operator=(UniqueResource&& other) noexcept {
+        if (this != &other) {
+            Reset(other.Release());
+            resource_.GetSecond() = std::forward<Deleter>(other.GetDeleter());
+        }
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    constexpr ~UniqueResource() noexcept {
+        Reset();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Gives up ownership: the caller frees the handle.
+    constexpr Handle Release() noexcept {
+        return std::exchange(resource_.GetFirst(), Sentinel);
+    }
+
+    // Frees the current handle (unless it is the sentinel or `handle` itself) and owns `handle`.
+    constexpr void Reset(Handle handle = Sentinel) noexcept {
+        if (!(handle == resource_.GetFirst())) {
+            Handle old_handle = std::exchange(resource_.GetFirst(), std::move(handle));
+            if (!(old_handle == Sentinel)) {
+                resource_.GetSecond()(old_handle);
+            }
+        }
+    }
+
+    constexpr void Swap(UniqueResource& other) noexcept {
+        std::swap(resource_.GetFirst(), other.resource_.GetFirst());
+        std::swap(resource_.GetSecond(), other.resource_.GetSecond());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    constexpr const Handle& Get() const noexcept {
+        return resource_.GetFirst();
+    }
+    constexpr Deleter& GetDeleter() {
+        return resource_.GetSecond();
+    }
+    constexpr const Deleter& GetDeleter() const {
+        return resource_.GetSecond();
+    }
+    constexpr explicit operator bool() const noexcept {
+        return !(resource_.GetFirst() == Sentinel);
+    }
+
+private:
+    CompressedPair<Handle, Deleter> resource_;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// File descriptors
+
+struct FdCloser {
+    void operator()(int fd) const {
+        close(fd);
+    }
+};
+
+// Any descriptor: files, sockets, pipes, epoll and event fds.
+using UniqueFd = UniqueResource<int, FdCloser, -1>;